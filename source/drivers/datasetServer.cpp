@@ -0,0 +1,88 @@
+// Publishes market data into named shared memory for other backtest processes, and attaches
+// to it the way a backtest process would.
+//
+// usage: datasetServer publish <name> <symbol> <csv or .qcol cache> [<symbol> <file> ...]
+//        datasetServer attach <name> <symbol>
+//        datasetServer remove <name>
+//        datasetServer cache <csv> <out.qcol>
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "components.h"
+#include "marketDataCache.h"
+#include "pipeline.h"
+#include "sharedDataset.h"
+#include "thresholdStrategy.h"
+
+static int publish(int argc, char** argv)
+{
+    sharedDatasetServer server;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        std::filesystem::path file = argv[i + 1];
+        if (file.extension() == ".qcol")
+        {
+            if (!server.addCache(argv[i], file))
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            server.add(argv[i], dataLoader(file).dataGet());
+        }
+    }
+    if (!server.publish(argv[2]))
+    {
+        return 1;
+    }
+    std::cout << "Published " << argv[2] << std::endl;
+    return 0;
+}
+
+static int attach(const std::string& name, const std::string& symbol)
+{
+    auto start = std::chrono::steady_clock::now();
+    sharedDataset dataset(name);
+    marketDataView view = dataset.find(symbol);
+    auto attached = std::chrono::steady_clock::now();
+    if (!dataset.good() || view.size == 0)
+    {
+        std::cerr << "No data for " << symbol << " in " << name << std::endl;
+        return 1;
+    }
+
+    staticThresholdStrategy strategy(10, 50);
+    staticBroker brkr;
+    backtestPipeline<staticThresholdStrategy, staticBroker> pipeline(strategy, brkr);
+    pipeline.run(view);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Attach: " << std::chrono::duration<double, std::milli>(attached - start).count() << " ms | "
+              << view.size << " bars backtested in " << std::chrono::duration<double, std::milli>(end - attached).count()
+              << " ms | trades: " << brkr.book().trades << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "publish" && argc >= 5)
+    {
+        return publish(argc, argv);
+    }
+    if (command == "attach" && argc == 4)
+    {
+        return attach(argv[2], argv[3]);
+    }
+    if (command == "cache" && argc == 4)
+    {
+        return writeMarketDataCache(argv[3], dataLoader(argv[2]).dataGet()) ? 0 : 1;
+    }
+    if (command == "remove" && argc == 3)
+    {
+        return sharedDataset::remove(argv[2]) ? 0 : 1;
+    }
+    std::cerr << "usage: " << argv[0] << " publish <name> <symbol> <csv|.qcol> [...] | attach <name> <symbol> | remove <name> | cache <csv> <out.qcol>" << std::endl;
+    return 1;
+}
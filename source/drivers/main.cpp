@@ -1,85 +1,86 @@
 #include <iostream>
 #include "ta_libc.h"
+#include "checkpoint.h"
 #include "components.h"
+#include "compressedLoader.h"
+#include "liveFeed.h"
+#include "thresholdStrategy.h"
 #include <vector>
 #include <filesystem>
-#include <random>
 #include <memory>
 #include <chrono>
 
-class ThresholdStrategy : public strategyEngine {
-public:
-    // Constructor
-    ThresholdStrategy(eventBus& Bus, double buyThreshold, double sellThreshold)
-        : strategyEngine(Bus), buyThreshold_(buyThreshold), sellThreshold_(sellThreshold) 
+// Paper-trades ThresholdStrategy against a live feed (e.g. replayFeed writing into a FIFO or socket)
+int runLive(const std::string& source, bool isSocket)
+{
+    int fd = isSocket ? liveFeed::connectSocket(source) : liveFeed::openPipe(source);
+    if (fd < 0)
     {
-        // Subscribe to MarketData events
-        //bus.subscribe("MarketData", std::bind(&ThresholdStrategy::onMarketData, this, std::placeholders::_1));
-        //bus.subscribe("MarketData", std::function<void(const marketDataEvent&)>([this](const marketDataEvent& evnt) { this->onMarketData(evnt); }));
-        bus.subscribe("MarketData", [this](event& evnt) 
-        {
-            if (auto marketDataEventPtr = dynamic_cast<marketDataEvent*>(&evnt)) {
-                this->onMarketData(*marketDataEventPtr);
-            }
-        });
-        std::cout << "Strategy Subscribed to MarketData events" << std::endl;
+        return 1;
     }
 
-    // Function to handle MarketData events
-    void onMarketData(const marketDataEvent& evnt)
-    {
-        std::cout << "Received MarketData event for timestamp: " << evnt.timestamp << std::endl;
-        // Extract MarketData and generate signals
-        const MarketData& marketData = extractMarketData(evnt);
-        std::unordered_map<std::string,double> signal = generateSignal(marketData);
-
-        std::string ts = marketData.timestamp;
-        signalEvent sigEvent{ts, signal};
-
-        bus.publish(sigEvent);
-    }
+    eventBus buss;
+    ThresholdStrategy myStrategy(buss, 10, 50);
+    broker amirreza(buss);
+    liveFeed feed(fd);
+    liveDataHandler handler(buss, feed, waitPolicy::adaptive);
+
+    // Console output suppressed while the feed runs, so the latencies measure the strategy
+    // rather than terminal flushes
+    feed.start();
+    std::cout.setstate(std::ios::failbit);
+    handler.run();
+    std::cout.clear();
+    feed.stop();
+
+    handler.latency().report(std::cout);
+    return 0;
+}
 
-    // Override the generateSignal function with the threshold strategy logic
-    std::unordered_map<std::string,double> generateSignal(const MarketData& marketData) override
+// Nightly incremental backtest: resumes from the checkpoint if there is one, replays only
+// the bars added to the history since, and leaves an updated checkpoint behind
+int runResume(const std::filesystem::path& history, const std::filesystem::path& checkpointPath)
+{
+    compressedDataLoader loader(history);
+    if (!loader.good())
     {
-        std::random_device rd;
-
-        // Use the random device to seed the random engine
-        std::mt19937 gen(rd());
-
-        // Define a range for the random numbers (in this case, from 1 to 100)
-        std::uniform_int_distribution<int> distribution(0, 3);
+        return 1;
+    }
+    std::vector<MarketData> histData = loader.dataGet();
 
-        // Generate a random number within the specified range
-        double randNum = distribution(gen)/2.0;
+    eventBus buss;
+    ThresholdStrategy myStrategy(buss, 10, 50);
+    broker amirreza(buss);
+    dataHandler handler(buss, histData);
 
-        if (marketData.close > marketData.close*randNum) {
-            std::cout << "Generated Buy signal for timestamp: " << marketData.timestamp << std::endl;
-            return {
-                {"type",1},
-                {"fraction",0.95}
-            };
-        } else if (marketData.close < marketData.close*randNum) {
-            std::cout << "Generated Sell signal for timestamp: " << marketData.timestamp << std::endl;
-            return {
-                {"type",2},
-                {"fraction",1.0},
-                {"closePrice",marketData.close}
-            };
-        } else {
-            std::cout << "No signal generated for timestamp: " << marketData.timestamp << std::endl;
-            return {{"type",0}};
+    backtestCheckpoint previous = backtestCheckpoint::load(checkpointPath);
+    if (!previous.empty())
+    {
+        if (!previous.restore(handler, myStrategy, amirreza))
+        {
+            return 1;
         }
+        std::cout << "Resuming after bar " << previous.barsProcessed() << " (" << previous.lastTimestamp() << ")" << std::endl;
     }
+    handler.simulateMarketData();
 
-private:
-    double buyThreshold_;
-    double sellThreshold_;
-};
+    return backtestCheckpoint::capture(handler, myStrategy, amirreza).save(checkpointPath) ? 0 : 1;
+}
 
-
-int main() 
+int main(int argc, char** argv) 
 {
+    // main --live <fifo> | main --live-socket <socket path>
+    if (argc > 2 && (std::string(argv[1]) == "--live" || std::string(argv[1]) == "--live-socket"))
+    {
+        return runLive(argv[2], std::string(argv[1]) == "--live-socket");
+    }
+
+    // main --resume <history.csv[.gz|.zst]> <checkpoint file>
+    if (argc > 3 && std::string(argv[1]) == "--resume")
+    {
+        return runResume(argv[2], argv[3]);
+    }
+
     auto start = std::chrono::high_resolution_clock::now();
 
     std::filesystem::path crpth=std::filesystem::current_path();
@@ -0,0 +1,134 @@
+// Per-bar overhead of the event-driven path (eventBus, std::function, dynamic_cast, virtual
+// evaluate) versus the compile-time backtestPipeline, both running the
+// ThresholdStrategy rule on the same bars with the same random stream: one strategy call
+// and one signal per bar on either path, so their trades must match. Also times the same
+// event-driven strategy and broker on a scheduled eventBus, the discrete-event
+// scheduledBacktest without and with simulated latency, and the raw eventScheduler.
+//
+// usage: pipelineBench [bars, default 1000000] [csv]
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "components.h"
+#include "pipeline.h"
+#include "scheduledBacktest.h"
+#include "thresholdStrategy.h"
+
+static std::vector<MarketData> syntheticBars(std::size_t count)
+{
+    std::vector<MarketData> bars;
+    bars.reserve(count);
+    philoxRng rng(1, 0);
+    double close = 100.0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        double open = close;
+        close *= 1.0 + (rng.uniform() - 0.5) * 0.002;
+        bars.emplace_back(convertTimestamp(1700000000000LL + static_cast<long long>(i) * 60000),
+                          open, std::max(open, close) * 1.0005, std::min(open, close) * 0.9995, close, 10.0);
+    }
+    return bars;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::vector<MarketData> bars = argc > 2 ? dataLoader(argv[2]).dataGet() : syntheticBars(count);
+    std::cout << "Bars: " << bars.size() << std::endl;
+
+    // Event-driven path, console output suppressed so only dispatch and logic are timed
+    rngService::setSeed(42);
+    eventBus buss;
+    ThresholdStrategy dynamicStrategy(buss, 10, 50);
+    broker dynamicBroker(buss);
+    dataHandler handler(buss, bars);
+
+    std::cout.setstate(std::ios::failbit);
+    auto start = std::chrono::steady_clock::now();
+    handler.simulateMarketData();
+    auto end = std::chrono::steady_clock::now();
+    std::cout.clear();
+    double dynamicNs = std::chrono::duration<double, std::nano>(end - start).count() / bars.size();
+
+    // Same strategy and broker, signals queued until the strategy's handler has returned
+    rngService::setSeed(42);
+    eventBus scheduledBuss(dispatchMode::scheduled);
+    ThresholdStrategy queuedStrategy(scheduledBuss, 10, 50);
+    broker queuedBroker(scheduledBuss);
+    dataHandler queuedHandler(scheduledBuss, bars);
+
+    std::cout.setstate(std::ios::failbit);
+    start = std::chrono::steady_clock::now();
+    queuedHandler.simulateMarketData();
+    end = std::chrono::steady_clock::now();
+    std::cout.clear();
+    double queuedNs = std::chrono::duration<double, std::nano>(end - start).count() / bars.size();
+
+    // Compile-time pipeline
+    rngService::setSeed(42);
+    staticThresholdStrategy staticStrat(10, 50);
+    staticBroker staticBrkr;
+    backtestPipeline<staticThresholdStrategy, staticBroker> pipeline(staticStrat, staticBrkr);
+
+    start = std::chrono::steady_clock::now();
+    pipeline.run(bars);
+    end = std::chrono::steady_clock::now();
+    double staticNs = std::chrono::duration<double, std::nano>(end - start).count() / bars.size();
+
+    // Discrete-event path; zero latency trades like the pipeline
+    rngService::setSeed(42);
+    staticThresholdStrategy scheduledStrat(10, 50);
+    scheduledBacktest<staticThresholdStrategy> scheduled(scheduledStrat, latencyModel{});
+
+    start = std::chrono::steady_clock::now();
+    scheduled.run(bars);
+    end = std::chrono::steady_clock::now();
+    double scheduledNs = std::chrono::duration<double, std::nano>(end - start).count() / bars.size();
+
+    rngService::setSeed(42);
+    staticThresholdStrategy latentStrat(10, 50);
+    latencyModel latency;
+    latency.marketData = std::chrono::milliseconds(5);
+    latency.order = std::chrono::milliseconds(20);
+    latency.ack = std::chrono::milliseconds(20);
+    latency.fill = std::chrono::milliseconds(25);
+    latency.jitter = std::chrono::milliseconds(10);
+    scheduledBacktest<staticThresholdStrategy> latent(latentStrat, latency);
+    latent.run(bars);
+
+    // Raw scheduler: a fixed population of timers that each reschedule themselves
+    eventScheduler sched;
+    philoxRng delays(7, 0);
+    std::size_t remaining = 20000000;
+    sched.on(simEventType::timer, [&](const simEvent& evnt) {
+        if (remaining > 0)
+        {
+            --remaining;
+            sched.after(std::chrono::nanoseconds(1 + delays.bounded(1000000)), evnt);
+        }
+    });
+    for (std::uint64_t id = 0; id < 4096; ++id)
+    {
+        simEvent timer;
+        timer.id = id;
+        sched.after(std::chrono::nanoseconds(delays.bounded(1000000)), timer);
+    }
+    start = std::chrono::steady_clock::now();
+    sched.run();
+    end = std::chrono::steady_clock::now();
+    double eventsPerSecond = sched.processed() / std::chrono::duration<double>(end - start).count();
+
+    std::cout << "eventBus path:       " << dynamicNs << " ns/bar | trades: " << dynamicBroker.book().trades << std::endl;
+    std::cout << "scheduled eventBus:  " << queuedNs << " ns/bar | trades: " << queuedBroker.book().trades << std::endl;
+    std::cout << "backtestPipeline:    " << staticNs << " ns/bar | trades: " << staticBrkr.book().trades << std::endl;
+    std::cout << "scheduledBacktest:   " << scheduledNs << " ns/bar | trades: " << scheduled.book().trades
+              << " (with latency: " << latent.book().trades << ")" << std::endl;
+    if (dynamicBroker.book().trades != staticBrkr.book().trades)
+    {
+        std::cout << "Paths disagree, the speedup does not compare like with like" << std::endl;
+    }
+    std::cout << "Speedup: " << dynamicNs / staticNs << "x" << std::endl;
+    std::cout << "eventScheduler:      " << eventsPerSecond / 1e6 << " M events/s" << std::endl;
+    return 0;
+}
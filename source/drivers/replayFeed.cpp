@@ -0,0 +1,124 @@
+// Local stand-in for an exchange feed: replays a historical CSV line by line into a FIFO,
+// a unix domain socket or stdout, optionally throttled to a fixed number of bars per second.
+//
+// usage: replayFeed <csv> [-|fifo path|--socket path] [bars per second, 0 = unthrottled]
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int listenAndAccept(const std::string& path)
+{
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str());
+    if (server < 0 || ::bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(server, 1) < 0)
+    {
+        std::cerr << "Error listening on: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        return -1;
+    }
+    std::cerr << "Waiting for a client on " << path << std::endl;
+    int client = ::accept(server, nullptr, nullptr);
+    ::close(server);
+    ::unlink(path.c_str());
+    return client;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <csv> [-|fifo path|--socket path] [bars per second]" << std::endl;
+        return 1;
+    }
+
+    // A reader that goes away should end the replay, not kill it
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::ifstream file(argv[1]);
+    if (!file.is_open())
+    {
+        std::cerr << "Error opening file: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    int argi = 2;
+    FILE* out = stdout;
+    if (argi < argc && std::string(argv[argi]) == "--socket" && argi + 1 < argc)
+    {
+        int fd = listenAndAccept(argv[argi + 1]);
+        if (fd < 0)
+        {
+            return 1;
+        }
+        out = ::fdopen(fd, "w");
+        argi += 2;
+    }
+    else if (argi < argc && std::string(argv[argi]) != "-")
+    {
+        // Opening a FIFO blocks until the reader side is open
+        out = std::fopen(argv[argi], "w");
+        if (!out)
+        {
+            std::cerr << "Error opening output: " << argv[argi] << std::endl;
+            return 1;
+        }
+        ++argi;
+    }
+    else if (argi < argc)
+    {
+        ++argi;
+    }
+
+    double barsPerSecond = argi < argc ? std::stod(argv[argi]) : 0.0;
+    auto interval = std::chrono::nanoseconds(barsPerSecond > 0 ? static_cast<long long>(1e9 / barsPerSecond) : 0);
+
+    std::string line;
+    std::getline(file, line);  // header
+
+    std::size_t sent = 0;
+    auto next = std::chrono::steady_clock::now();
+    while (std::getline(file, line))
+    {
+        if (interval.count() > 0)
+        {
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+        line.push_back('\n');
+        if (std::fwrite(line.data(), 1, line.size(), out) != line.size())
+        {
+            // Reader went away
+            break;
+        }
+        // Throttled feeds behave like a live exchange, one bar per write
+        if (interval.count() > 0)
+        {
+            std::fflush(out);
+        }
+        ++sent;
+    }
+    std::fflush(out);
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+
+    std::cerr << "Replayed " << sent << " bars" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Bump allocator for short-lived per-bar objects (events, timestamps, signal payloads).
+// Memory is handed out from large blocks and only given back all at once by reset().
+// Blocks are kept across resets, so once the arena has grown to the size of one batch
+// a replay runs without touching the global heap.
+//
+// Anything allocated from the arena must not be used after the next reset().
+class eventArena
+{
+public:
+    explicit eventArena(std::size_t blockSize = 1 << 20) : blockSize_(blockSize) {}
+
+    ~eventArena()
+    {
+        reset();
+        for (auto& blk : blocks_)
+        {
+            ::operator delete(blk.data);
+        }
+    }
+
+    eventArena(const eventArena&) = delete;
+    eventArena& operator=(const eventArena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        while (blockIndex_ < blocks_.size())
+        {
+            block& blk = blocks_[blockIndex_];
+            std::size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= blk.size)
+            {
+                offset_ = start + bytes;
+                bytesUsed_ += bytes;
+                return blk.data + start;
+            }
+            // Current block is exhausted, move on to the next retained one
+            ++blockIndex_;
+            offset_ = 0;
+        }
+
+        // Only reached while the arena is still growing
+        std::size_t size = std::max(blockSize_, bytes + alignment);
+        blocks_.push_back({static_cast<char*>(::operator new(size)), size});
+        blockIndex_ = blocks_.size() - 1;
+        offset_ = 0;
+        return allocate(bytes, alignment);
+    }
+
+    // Constructs an object inside the arena; its destructor runs on reset()
+    template <class T, class... Args>
+    T* create(Args&&... args)
+    {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            auto* node = new (allocate(sizeof(cleanup), alignof(cleanup))) cleanup{
+                [](void* p) { static_cast<T*>(p)->~T(); }, object, cleanups_};
+            cleanups_ = node;
+        }
+        return object;
+    }
+
+    // Destroys every created object (newest first) and rewinds to the first block
+    void reset()
+    {
+        while (cleanups_)
+        {
+            cleanup* next = cleanups_->next;
+            cleanups_->destroy(cleanups_->object);
+            cleanups_ = next;
+        }
+        blockIndex_ = 0;
+        offset_ = 0;
+        bytesUsed_ = 0;
+    }
+
+    std::size_t bytesUsed() const { return bytesUsed_; }
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    // Arena that arenaAllocator instances created on this thread draw from, or nullptr
+    static eventArena* current() { return currentSlot(); }
+
+private:
+    friend class arenaScope;
+
+    struct block
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    struct cleanup
+    {
+        void (*destroy)(void*);
+        void* object;
+        cleanup* next;
+    };
+
+    static eventArena*& currentSlot()
+    {
+        static thread_local eventArena* slot = nullptr;
+        return slot;
+    }
+
+    std::size_t blockSize_;
+    std::vector<block> blocks_;
+    std::size_t blockIndex_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t bytesUsed_ = 0;
+    cleanup* cleanups_ = nullptr;
+};
+
+// Makes an arena the current one for this thread for the lifetime of the scope
+class arenaScope
+{
+public:
+    explicit arenaScope(eventArena& arena) : previous_(eventArena::currentSlot())
+    {
+        eventArena::currentSlot() = &arena;
+    }
+    ~arenaScope() { eventArena::currentSlot() = previous_; }
+
+    arenaScope(const arenaScope&) = delete;
+    arenaScope& operator=(const arenaScope&) = delete;
+
+private:
+    eventArena* previous_;
+};
+
+// Standard allocator drawing from an arena, or from the global heap when it has none.
+// Deallocation into an arena is a no-op. Containers are on the heap unless they are given
+// an arena explicitly, so a container a user moves somewhere never ends up pointing into
+// memory the next reset() reuses.
+template <class T>
+class arenaAllocator
+{
+public:
+    using value_type = T;
+
+    arenaAllocator() noexcept : arena_(nullptr) {}
+    explicit arenaAllocator(eventArena* arena) noexcept : arena_(arena) {}
+    template <class U>
+    arenaAllocator(const arenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (arena_)
+        {
+            return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        if (!arena_)
+        {
+            ::operator delete(p);
+        }
+    }
+
+    // Copies go to the global heap: a subscriber that keeps a copy of a payload, e.g. in a
+    // history, must not be left holding memory the next reset() reuses
+    arenaAllocator select_on_container_copy_construction() const { return arenaAllocator(nullptr); }
+
+    eventArena* arena() const noexcept { return arena_; }
+
+private:
+    eventArena* arena_;
+};
+
+template <class T, class U>
+bool operator==(const arenaAllocator<T>& a, const arenaAllocator<U>& b) noexcept { return a.arena() == b.arena(); }
+
+template <class T, class U>
+bool operator!=(const arenaAllocator<T>& a, const arenaAllocator<U>& b) noexcept { return a.arena() != b.arena(); }
+
+using arenaString = std::basic_string<char, std::char_traits<char>, arenaAllocator<char>>;
+
+// Signal payload for plugins, e.g. {{"type",1},{"fraction",0.95}}. On the heap like any
+// map; the framework's own strategies publish a plain tradeSignal instead.
+using signalMap = std::unordered_map<std::string, double, std::hash<std::string>, std::equal_to<std::string>,
+                                     arenaAllocator<std::pair<const std::string, double>>>;
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "components.h"
+
+// Appends plain values to a checkpoint section. Values are stored in host byte order:
+// checkpoints are meant to be resumed on the machine type that wrote them.
+class checkpointWriter
+{
+public:
+    template <typename T>
+    void put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written directly");
+        const char* raw = reinterpret_cast<const char*>(&value);
+        bytes_.insert(bytes_.end(), raw, raw + sizeof(T));
+    }
+
+    void putString(std::string_view text)
+    {
+        put<std::uint64_t>(text.size());
+        bytes_.insert(bytes_.end(), text.begin(), text.end());
+    }
+
+    const std::vector<char>& bytes() const { return bytes_; }
+    std::vector<char> release() { return std::move(bytes_); }
+
+private:
+    std::vector<char> bytes_;
+};
+
+// Reads values back in the order they were put. A read past the end fails and leaves the
+// reader !good(), so loaders can read everything and check once.
+class checkpointReader
+{
+public:
+    checkpointReader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read directly");
+        if (!good_ || size_ - pos_ < sizeof(T))
+        {
+            good_ = false;
+            return false;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& text)
+    {
+        std::uint64_t length = 0;
+        if (!get(length) || size_ - pos_ < length)
+        {
+            good_ = false;
+            return false;
+        }
+        text.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    bool good() const { return good_; }
+    bool atEnd() const { return pos_ == size_; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+    bool good_ = true;
+};
+
+// Snapshot of an event-driven backtest between two bars: the data cursor, the strategy's
+// state (strategyEngine::saveState) and the broker's portfolio.
+//
+// Nightly runs capture() after the replay, save() the checkpoint, and the next night
+// load() + restore() it into freshly built components over the extended history, so
+// simulateMarketData only processes the appended bars. restore() checks that the history
+// still has the bar the checkpoint stopped after. Handlers that replay a view or a source
+// have no history to check, so there the caller must pass the same bars, extended.
+//
+// One checkpoint can be restored into any number of component sets, e.g. strategies built
+// with different parameters, to fork a warmed-up state into parameter variants.
+class backtestCheckpoint
+{
+public:
+    static backtestCheckpoint capture(const dataHandler& handler, const strategyEngine& strategy, const broker& brkr);
+
+    bool restore(dataHandler& handler, strategyEngine& strategy, broker& brkr) const;
+
+    // Written next to path and renamed into place, so a crash never leaves a partial file
+    bool save(const std::filesystem::path& path) const;
+
+    // empty() if the file is missing or not a checkpoint
+    static backtestCheckpoint load(const std::filesystem::path& path);
+
+    bool empty() const { return !valid_; }
+
+    // Bars replayed before the snapshot, i.e. the cursor to resume from
+    std::uint64_t barsProcessed() const { return cursor_; }
+    const std::string& lastTimestamp() const { return lastTimestamp_; }
+
+private:
+    bool valid_ = false;
+    std::uint64_t cursor_ = 0;
+    std::string lastTimestamp_;
+    std::vector<char> strategyState_;
+    portfolio book_;
+};
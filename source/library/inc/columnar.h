@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Minimal binary columnar file format used for caches and results.
+//
+//   fileHeader
+//   columnDesc[columnCount]
+//   metadataHeader, then size bytes padded to 8   (version 2 only)
+//   chunk*   -> chunkHeader, then each column's rowCount values back to back
+//
+// The metadata is an opaque blob describing the file as a whole (e.g. the key a cache file
+// was written for). Files without metadata are written as version 1.
+//
+// Every column in a chunk is a contiguous array with 8-byte aligned start, so a
+// single-chunk file can be mmapped and used in place. Writers only ever append chunks,
+// which lets a file grow while it is being produced.
+enum class columnType : std::uint32_t { f64 = 0, i64 = 1, text = 2 };
+
+constexpr char COLUMNAR_MAGIC[8] = {'Q', 'C', 'O', 'L', 'U', 'M', 'N', '1'};
+constexpr std::size_t COLUMNAR_NAME_SIZE = 32;
+constexpr std::uint32_t COLUMNAR_VERSION_METADATA = 2;
+
+struct columnarFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columnCount;
+};
+
+struct columnarColumnDesc
+{
+    char name[COLUMNAR_NAME_SIZE];
+    columnType type;
+    std::uint32_t width;   // bytes per value; 8 for numbers, fixed (padded) size for text
+};
+
+struct columnarMetadataHeader
+{
+    std::uint64_t size;   // bytes of metadata, not counting the padding
+};
+
+struct columnarChunkHeader
+{
+    std::uint64_t rowCount;
+};
+
+static_assert(sizeof(columnarFileHeader) % 8 == 0 && sizeof(columnarColumnDesc) % 8 == 0 && sizeof(columnarMetadataHeader) % 8 == 0 &&
+              sizeof(columnarChunkHeader) % 8 == 0,
+              "Column arrays must stay 8-byte aligned");
+
+struct columnSpec
+{
+    std::string name;
+    columnType type;
+    std::uint32_t width;
+
+    static columnSpec f64(const std::string& name) { return {name, columnType::f64, 8}; }
+    static columnSpec i64(const std::string& name) { return {name, columnType::i64, 8}; }
+    static columnSpec text(const std::string& name, std::uint32_t width) { return {name, columnType::text, (width + 7) / 8 * 8}; }
+};
+
+class columnarWriter
+{
+public:
+    // Creates (or truncates) the file and writes the schema and metadata; check good() afterwards
+    columnarWriter(const std::filesystem::path& path, const std::vector<columnSpec>& schema, const std::string& metadata = {});
+    ~columnarWriter();
+
+    columnarWriter(const columnarWriter&) = delete;
+    columnarWriter& operator=(const columnarWriter&) = delete;
+
+    bool good() const { return file_ != nullptr; }
+    const std::vector<columnSpec>& schema() const { return schema_; }
+
+    // One pointer per schema column, each to rowCount values of that column's width
+    bool appendChunk(const std::vector<const void*>& columns, std::uint64_t rowCount);
+
+    void flush();
+
+private:
+    FILE* file_ = nullptr;
+    std::vector<columnSpec> schema_;
+};
+
+// Reads a whole file into memory, concatenating all chunks
+class columnarReader
+{
+public:
+    explicit columnarReader(const std::filesystem::path& path);
+
+    bool good() const { return good_; }
+    std::uint64_t rowCount() const { return rowCount_; }
+    const std::vector<columnSpec>& schema() const { return schema_; }
+    const std::string& metadata() const { return metadata_; }
+    bool has(const std::string& name) const { return index(name) >= 0; }
+
+    // Empty when the column does not exist or has another type
+    std::vector<double> f64(const std::string& name) const;
+    std::vector<std::int64_t> i64(const std::string& name) const;
+    std::vector<std::string> text(const std::string& name) const;
+
+    // Raw values of a column (rowCount * width bytes), nullptr when it does not exist
+    const std::vector<char>* raw(const std::string& name) const
+    {
+        int i = index(name);
+        return i < 0 ? nullptr : &data_[i];
+    }
+
+private:
+    int index(const std::string& name) const;
+
+    bool good_ = false;
+    std::uint64_t rowCount_ = 0;
+    std::vector<columnSpec> schema_;
+    std::string metadata_;
+    std::vector<std::vector<char>> data_;   // raw bytes per column
+};
+
+// Reads a file a bounded number of rows at a time, seeking inside chunks, so a file of
+// any size can be scanned with fixed memory
+class columnarStreamReader
+{
+public:
+    explicit columnarStreamReader(const std::filesystem::path& path);
+    ~columnarStreamReader();
+
+    columnarStreamReader(const columnarStreamReader&) = delete;
+    columnarStreamReader& operator=(const columnarStreamReader&) = delete;
+
+    bool good() const { return file_ != nullptr; }
+    const std::vector<columnSpec>& schema() const { return schema_; }
+    const std::string& metadata() const { return metadata_; }
+
+    // -1 when the column does not exist
+    int column(const std::string& name) const;
+
+    // Reads up to maxRows further rows; columns[i] receives rows * width bytes of schema
+    // column i. Returns the number of rows read, 0 at the end (or at a torn tail).
+    std::uint64_t read(std::vector<std::vector<char>>& columns, std::uint64_t maxRows);
+
+private:
+    bool nextChunk();
+
+    FILE* file_ = nullptr;
+    std::vector<columnSpec> schema_;
+    std::string metadata_;
+    std::uint64_t fileSize_ = 0;
+    std::uint64_t chunkStart_ = 0;   // offset of the current chunk's first column
+    std::uint64_t chunkRows_ = 0;
+    std::uint64_t chunkPos_ = 0;     // rows of the current chunk already read
+};
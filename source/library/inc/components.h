@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <vector>
 #include <functional>
@@ -15,20 +17,17 @@
 #include <mutex>
 #include <shared_mutex>
 #include <condition_variable>
-
-std::string convertTimestamp(const std::string& timestampString, const char* format = "%Y-%m-%d %H:%M:%S") {
-    // Convert string to double
-    double timestamp;
-    std::istringstream iss(timestampString);
-    iss >> timestamp;
-
-    if (iss.fail()) {
-        // Handle parsing error
-        return "Invalid timestamp format";
-    }
-
+#include <chrono>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include "arena.h"
+#include "eventScheduler.h"
+#include "rng.h"
+
+inline std::string convertTimestamp(long long timestampMs, const char* format = "%Y-%m-%d %H:%M:%S") {
     // Convert milliseconds to std::chrono::milliseconds
-    std::chrono::milliseconds milliseconds(static_cast<long long>(timestamp));
+    std::chrono::milliseconds milliseconds(timestampMs);
 
     // Get the duration since the epoch
     auto durationSinceEpoch = std::chrono::duration_cast<std::chrono::system_clock::duration>(milliseconds);
@@ -50,6 +49,20 @@ std::string convertTimestamp(const std::string& timestampString, const char* for
     return std::string(buffer);
 }
 
+inline std::string convertTimestamp(const std::string& timestampString, const char* format = "%Y-%m-%d %H:%M:%S") {
+    // Convert string to double
+    double timestamp;
+    std::istringstream iss(timestampString);
+    iss >> timestamp;
+
+    if (iss.fail()) {
+        // Handle parsing error
+        return "Invalid timestamp format";
+    }
+
+    return convertTimestamp(static_cast<long long>(timestamp), format);
+}
+
 struct MarketData 
 { 
     MarketData(std::string ts, double o, double h, double l, double c, double v):
@@ -64,6 +77,37 @@ struct MarketData
     double volume;
 };
 
+// Read-only columnar view of bars owned by someone else (a shared memory segment, a mapped
+// cache file). Timestamps are fixed-width, zero padded text.
+struct marketDataView
+{
+    std::size_t size = 0;
+    std::uint32_t timestampWidth = 0;
+    const char* timestamps = nullptr;
+    const double* open = nullptr;
+    const double* high = nullptr;
+    const double* low = nullptr;
+    const double* close = nullptr;
+    const double* volume = nullptr;
+
+    std::string_view timestamp(std::size_t i) const
+    {
+        const char* ts = timestamps + i * timestampWidth;
+        return {ts, strnlen(ts, timestampWidth)};
+    }
+
+    // Copies bar i into an existing MarketData, reusing its string capacity
+    void fill(std::size_t i, MarketData& bar) const
+    {
+        bar.timestamp.assign(timestamp(i));
+        bar.open = open[i];
+        bar.high = high[i];
+        bar.low = low[i];
+        bar.close = close[i];
+        bar.volume = volume[i];
+    }
+};
+
 class dataLoader
 {
 public:
@@ -517,12 +561,15 @@ private:
 class event 
 {
 public:
-    std::string type;  // Event type (e.g., "MarketData", "Signal")
-    std::string timestamp="";
-    std::vector<double> data_;
+    std::string type;  // Event type (e.g., "MarketData", "Signal"), short enough to never allocate
+    arenaString timestamp;  // Lives in the current eventArena while a replay is running
 
-    event(const std::string& ty, const std::string& ts): type(ty), timestamp(ts) {}
+    event(const std::string& ty, std::string_view ts): type(ty), timestamp(ts.data(), ts.size(), arenaAllocator<char>(eventArena::current())) {}
     virtual ~event() = default;
+
+    // Heap copy for a scheduled eventBus to hold until dispatch. Event types that do not
+    // override it are dispatched immediately even on a scheduled bus.
+    virtual std::unique_ptr<event> clone() const { return nullptr; }
     // MarketData dataMarket={"MarketData",0,0,0,0,0};
     // std::unordered_map<std::string,double> signalData {{"type",0}};
     
@@ -535,39 +582,108 @@ public:
     // event(std::string ty, std::string ts, std::unordered_map<std::string,double> sigData): type(ty), timestamp(ts), signalData(sigData) {}
 };
 
+// Refers to a bar owned by the data source instead of copying it; events are only
+// valid while they are being dispatched
 struct marketDataEvent : public event {
-    marketDataEvent(const std::string& ts, MarketData data)
+    marketDataEvent(std::string_view ts, const MarketData& data)
         : event("MarketData", ts), data_(data) {}
 
-    MarketData data_;
+    std::unique_ptr<event> clone() const override { return std::make_unique<marketDataEvent>(*this); }
+
+    const MarketData& data_;
+};
+
+// Signal type (0 hold, 1 buy, 2 sell), the fraction of cash or position to trade and the
+// price it was decided at, which holds carry too so the broker can mark to market. Plain data, so publishing one per bar does not allocate.
+struct tradeSignal
+{
+    int type = 0;
+    double fraction = 0;
+    double closePrice = 0;
 };
 
+// Reads the type, fraction and closePrice keys of a plugin's map; missing keys are 0
+inline tradeSignal toTradeSignal(const signalMap& data)
+{
+    auto value = [&data](const char* key) {
+        auto it = data.find(key);
+        return it != data.end() ? it->second : 0.0;
+    };
+    return {static_cast<int>(value("type")), value("fraction"), value("closePrice")};
+}
+
 struct signalEvent : public event {
-    signalEvent(const std::string& ts, std::unordered_map<std::string, double> data)
-        : event("Signal", ts), data_(data) {}
+    signalEvent(std::string_view ts, const tradeSignal& signal)
+        : event("Signal", ts), signal_(signal) {}
+
+    // For plugins that build a map; keys beyond the signal's stay available in data_
+    signalEvent(std::string_view ts, signalMap data)
+        : event("Signal", ts), signal_(toTradeSignal(data)), data_(std::move(data)) {}
 
-    std::unordered_map<std::string, double> data_;
+    std::unique_ptr<event> clone() const override { return std::make_unique<signalEvent>(*this); }
+
+    tradeSignal signal_;
+    signalMap data_;  // empty unless the publisher passed a map
 };
 
+// immediate: publish() runs the subscribers on the spot, so a Signal published from a
+// MarketData handler is executed by the broker before the strategy's handler returns.
+// scheduled: events published while another one is being dispatched are queued on an
+// eventScheduler and dispatched in order once the current handler has returned, so handlers
+// never nest. A top-level publish() returns after the queue has run dry.
+enum class dispatchMode { immediate, scheduled };
+
 class eventBus
 {
 public:
+    explicit eventBus(dispatchMode mode = dispatchMode::immediate);
+
+    eventBus(const eventBus&) = delete;
+    eventBus& operator=(const eventBus&) = delete;
+
     void subscribe(const std::string& eventType, std::function<void(event&)> callback);
 
+    // Runs ahead of the subscribers registered so far, e.g. to timestamp an event before
+    // anyone acts on it
+    void subscribeFirst(const std::string& eventType, std::function<void(event&)> callback);
+
     void publish(event& evnt);
+
+    // Queue of a scheduled bus, e.g. to add timers; nullptr for an immediate bus
+    eventScheduler* scheduler() { return scheduler_.get(); }
 private:
+    void dispatch(event& evnt);
+
     std::unordered_map<std::string, std::vector<std::function<void(event&)>>> subscribers;
+
+    std::unique_ptr<eventScheduler> scheduler_;
+    std::vector<std::unique_ptr<event>> queued_;   // events waiting for dispatch, by simEvent::id
+    std::vector<std::uint64_t> freeSlots_;
+    bool dispatching_ = false;
 };
 
+class marketDataSource;
+
 class dataHandler 
 {
 public:
     // Constructor
     dataHandler(eventBus& Bus,const std::vector<MarketData>& historicalData) : bus(Bus), historicalMarketData(historicalData) {}
 
-    // Function to simulate market data generation
+    // Function to simulate market data generation, from currentDataIndex to the end.
+    // Leaves the cursor at the end; resetIteration() replays from the start again.
     void simulateMarketData();
 
+    // Same as simulateMarketData, replaying bars straight from a columnar view; the cursor
+    // is a position in the view
+    void simulateMarketData(const marketDataView& view);
+
+    // Same as simulateMarketData, streaming the bars from a source in chunks of chunkBars.
+    // The cursor is a position in the source: bars before it are read and skipped.
+    // The next chunks load on a background thread during the replay, and at most
+    // windowChunks chunks are in memory at a time (see chunkReadAhead).
+    void simulateMarketData(marketDataSource& source, std::size_t chunkBars = 1 << 16, std::size_t windowChunks = 3);
+
     void simulateMarketDataAsync() 
     {
         constexpr std::size_t NUM_THREADS = 4; // Adjust the number of threads as needed
@@ -596,8 +712,13 @@ public:
     void simulateNextMarketDataEvent();
 
     std::vector<MarketData> historicalMarketData;
-    eventBus bus;
+    eventBus& bus;
     size_t currentDataIndex = 0;
+
+    // Events and signal payloads of a replay are carved out of this arena, which is
+    // rewound every ARENA_BATCH_SIZE bars
+    static constexpr std::size_t ARENA_BATCH_SIZE = 1024;
+    eventArena arena;
 private:
     void simulateMarketDataWorker() 
     {
@@ -616,11 +737,14 @@ private:
     }
 };
 
+class checkpointWriter;
+class checkpointReader;
+
 class strategyEngine 
 {
 public:
     // Constructor
-    explicit strategyEngine(eventBus& Bus) : bus(Bus) 
+    explicit strategyEngine(eventBus& Bus) : bus(Bus), rng(rngService::next()) 
     {
         // Subscribe to MarketData events
         //bus.subscribe("MarketData", std::bind(&strategyEngine::onMarketData, this, std::placeholders::_1));
@@ -632,16 +756,64 @@ public:
         });
     }
 
-    // Function to handle MarketData events
-    void onMarketData(const marketDataEvent& evnt);
+    // Function to handle MarketData events; the base subscription dispatches here, so derived
+    // classes override it instead of subscribing again
+    virtual void onMarketData(const marketDataEvent& evnt);
 
     // Function to be overridden by derived classes to implement strategy logic
-    virtual std::unordered_map<std::string,double> generateSignal(const MarketData& marketData);
+    virtual signalMap generateSignal(const MarketData& marketData);
+
+    // Checkpoint hooks (see backtestCheckpoint). Derived classes that keep state across
+    // bars, e.g. running indicators, override both and call the base first; parameters
+    // are not state, so a checkpoint can be restored into differently tuned strategies.
+    virtual void saveState(checkpointWriter& out) const;
+    virtual bool loadState(checkpointReader& in);
+
+    virtual ~strategyEngine() = default;
 
 protected:
     // Helper function to extract MarketData from the event
-    MarketData extractMarketData(const marketDataEvent& evnt);
+    const MarketData& extractMarketData(const marketDataEvent& evnt);
     eventBus& bus;
+
+    // Reproducible per-strategy random stream, see rngService::setSeed
+    philoxRng rng;
+};
+
+class resultsWriter;
+
+// Cash/asset bookkeeping shared by the event-driven broker and the static pipeline
+struct portfolio
+{
+    double cash = 1000.0;  // Initial cash amount for the portfolio
+    double asset = 0;
+    bool inPosition = false; // Indicates whether the broker is in position
+    std::size_t trades = 0;  // Executed buy and sell orders
+
+    // Spends fraction of the cash on the asset at the fill price
+    void buy(double fraction, double fillPrice)
+    {
+        if (fillPrice <= 0)
+        {
+            return;
+        }
+        double spent = cash*fraction;
+        cash -= spent;
+        asset += spent/fillPrice;
+        inPosition = true;
+        ++trades;
+    }
+
+    void sell(double fraction, double closePrice)
+    {
+        if(inPosition==true)
+        {
+            cash += asset*fraction*closePrice;
+            asset=asset-asset*fraction;
+            inPosition = false;
+            ++trades;
+        }
+    }
 };
 
 class broker 
@@ -667,11 +839,18 @@ public:
     // Function to execute a Sell order
     void executeSellOrder(const signalEvent& evnt);
 
+    const portfolio& book() const { return book_; }
+
+    // Used when resuming from a checkpoint
+    void setBook(const portfolio& book) { book_ = book; }
+
+    // Optional sink for fills, positions and equity points; not owned
+    void setResultsWriter(resultsWriter* writer) { results_ = writer; }
+
 private:
     eventBus& bus;
-    double cash = 1000.0;  // Initial cash amount for the portfolio
-    double asset = 0;
-    bool inPosition = false; // Indicates whether the broker is in position
+    portfolio book_;
+    resultsWriter* results_ = nullptr;
 };
 
 
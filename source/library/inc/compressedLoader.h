@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "components.h"
+#include "ringBuffer.h"
+
+// Reads a plain, gzip or zstd file on a background thread and hands out its decompressed
+// bytes in BLOCK_SIZE blocks, at most queueBlocks ahead of the consumer. The format is
+// detected from the magic bytes.
+class csvBlockReader
+{
+public:
+    static constexpr std::size_t BLOCK_SIZE = 4 << 20;
+
+    explicit csvBlockReader(const std::filesystem::path& path, std::size_t queueBlocks = 4);
+    ~csvBlockReader();
+
+    csvBlockReader(const csvBlockReader&) = delete;
+    csvBlockReader& operator=(const csvBlockReader&) = delete;
+
+    // False at the end of the file or after an error
+    bool nextBlock(std::string& block);
+
+    // Once nextBlock returned false: whether the whole file was read
+    bool good() const { return good_; }
+    std::size_t bytesDecompressed() const { return bytesDecompressed_; }
+
+private:
+    enum class compression { none, gzip, zstd };
+
+    static compression detect(std::istream& file);
+    void decompress(compression type);
+
+    std::filesystem::path path_;
+    std::ifstream file_;
+    boundedQueue<std::string> blocks_;
+    // Written by the reader thread before it closes blocks_
+    bool good_ = false;
+    std::size_t bytesDecompressed_ = 0;
+    std::thread thread_;
+};
+
+// Parses one line of dataLoader's CSV layout, without its '\n'. False for the header and
+// for malformed lines.
+bool parseMarketDataLine(const char* begin, const char* end, MarketData& bar);
+
+// Loads dataLoader's CSV layout straight from plain, gzip (.csv.gz) or zstd (.csv.zst)
+// files, without decompressing to disk first. The format is detected from the magic bytes.
+//
+// Three stages run on their own threads and overlap:
+//   csvBlockReader -> raw blocks -> split at line ends -> whole-line blocks -> parsers
+// Stages are connected by boundedQueues of 4 MiB blocks, so synchronisation is per
+// block rather than per line, and memory stays at a few blocks per stage however large
+// the file is. Rows come out in file order.
+//
+// gzip support needs QENG_HAVE_ZLIB and zstd needs QENG_HAVE_ZSTD; CMake defines them
+// when the libraries are found.
+class compressedDataLoader
+{
+public:
+    static constexpr std::size_t QUEUE_BLOCKS = 4;
+
+    compressedDataLoader(std::filesystem::path path, std::size_t numParsers = std::thread::hardware_concurrency())
+        : filePath(path), numParsers(numParsers ? numParsers : 1) {loadData();}
+
+    bool good() const { return good_; }
+
+    std::vector<MarketData> dataGet() { return data_; }
+    const std::vector<MarketData>& data() const { return data_; }
+
+    // Size of the CSV text after decompression
+    std::size_t bytesDecompressed() const { return bytesDecompressed_; }
+    std::size_t malformedLines() const { return malformedLines_; }
+
+private:
+    struct lineBlock
+    {
+        std::size_t index;
+        std::string text;   // whole lines only, each ending in '\n'
+    };
+
+    void loadData();
+    static void splitLines(csvBlockReader& in, boundedQueue<lineBlock>& out);
+    static std::size_t parseBlock(const std::string& text, std::vector<MarketData>& rows);
+
+    std::filesystem::path filePath;
+    std::size_t numParsers;
+    std::vector<MarketData> data_;
+    std::size_t bytesDecompressed_ = 0;
+    std::size_t malformedLines_ = 0;
+    bool good_ = false;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Monotone priority queue keyed by 64-bit time (radix heap, Ahuja et al.). Entries live in
+// 65 vectors bucketed by the highest bit in which their key differs from the last key
+// popped, so push is an append and each entry is moved O(log range) times in total,
+// instead of the pointer chasing and O(log n) swaps of a binary heap.
+//
+// Keys must never be below the last popped key, which holds for simulated time. Entries
+// with equal keys come out in the order they were pushed.
+template <typename T>
+class radixHeap
+{
+public:
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void push(std::uint64_t key, const T& value)
+    {
+        buckets_[bucketOf(key)].push_back({key, value});
+        ++size_;
+    }
+
+    // Smallest key; the heap must not be empty. Only looks, so keys between the last popped
+    // one and this one can still be pushed afterwards.
+    std::uint64_t topKey() const
+    {
+        if (head_ < buckets_[0].size())
+        {
+            return last_;
+        }
+        return smallestKey(firstNonEmpty());
+    }
+
+    // Removes the entry with the smallest key; the heap must not be empty
+    T pop()
+    {
+        refill();
+        --size_;
+        return buckets_[0][head_++].value;
+    }
+
+    // Key of the entry popped last
+    std::uint64_t lastKey() const { return last_; }
+
+private:
+    struct entry
+    {
+        std::uint64_t key;
+        T value;
+    };
+
+    int bucketOf(std::uint64_t key) const
+    {
+        return key == last_ ? 0 : 64 - __builtin_clzll(key ^ last_);
+    }
+
+    // Lowest bucket above 0 holding entries, once bucket 0 is used up
+    std::size_t firstNonEmpty() const
+    {
+        std::size_t i = 1;
+        while (buckets_[i].empty())
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    std::uint64_t smallestKey(std::size_t bucket) const
+    {
+        std::uint64_t smallest = std::numeric_limits<std::uint64_t>::max();
+        for (const auto& e : buckets_[bucket])
+        {
+            smallest = e.key < smallest ? e.key : smallest;
+        }
+        return smallest;
+    }
+
+    // Makes buckets_[0] hold the entries with the smallest key
+    void refill()
+    {
+        if (head_ < buckets_[0].size())
+        {
+            return;
+        }
+        buckets_[0].clear();
+        head_ = 0;
+
+        const std::size_t i = firstNonEmpty();
+        // Everything in bucket i now lands in a lower bucket; buckets below i are empty, so
+        // push order is preserved within each bucket
+        last_ = smallestKey(i);
+        for (const auto& e : buckets_[i])
+        {
+            buckets_[bucketOf(e.key)].push_back(e);
+        }
+        buckets_[i].clear();
+    }
+
+    std::array<std::vector<entry>, 65> buckets_;
+    std::size_t head_ = 0;      // next entry of buckets_[0] to pop
+    std::uint64_t last_ = 0;
+    std::size_t size_ = 0;
+};
+
+// Messages of a simulated run. Plain 32-byte data, so the queue stores them by value and
+// moving them between buckets stays cheap.
+enum class simEventType : std::uint8_t
+{
+    bar,          // a bar closes at the exchange
+    marketData,   // the bar reaches the strategy
+    order,        // an order reaches the exchange
+    ack,          // the exchange's acknowledgement reaches the strategy
+    fill,         // the execution report reaches the strategy
+    timer,        // a timer set by a strategy or plugin
+    bus,          // an eventBus event queued for dispatch, id is its slot
+    count
+};
+
+struct simEvent
+{
+    simEventType type = simEventType::timer;
+    std::uint8_t side = 0;          // 1 buy, 2 sell (same codes as signals)
+    std::uint32_t tag = 0;          // free for plugins, e.g. a symbol or strategy index
+    std::uint64_t id = 0;           // bar index, order id or timer id
+    double fraction = 0;
+    double price = 0;
+};
+
+static_assert(sizeof(simEvent) == 32, "Keep simEvent small, the queue copies it around");
+
+// Discrete-event scheduler: handlers run one at a time in simulated-time order and schedule
+// follow-up events instead of calling each other, so nothing nests and a message can take
+// time to arrive. Ties are broken by scheduling order, which keeps runs deterministic.
+// Time is in simulated nanoseconds from the start of the run.
+class eventScheduler
+{
+public:
+    using handler = std::function<void(const simEvent&)>;
+
+    // Handlers of one type run in registration order
+    void on(simEventType type, handler callback) { handlers_[static_cast<std::size_t>(type)].push_back(std::move(callback)); }
+
+    // Events cannot be scheduled in the past; earlier times are treated as now
+    void at(std::uint64_t time, const simEvent& evnt) { queue_.push(time < now_ ? now_ : time, evnt); }
+
+    void after(std::chrono::nanoseconds delay, const simEvent& evnt) { at(now_ + static_cast<std::uint64_t>(delay.count()), evnt); }
+
+    std::uint64_t now() const { return now_; }
+    std::size_t pending() const { return queue_.size(); }
+    std::size_t processed() const { return processed_; }
+
+    // Dispatches the next event; false when there is none
+    bool step()
+    {
+        if (queue_.empty())
+        {
+            return false;
+        }
+        const simEvent evnt = queue_.pop();
+        now_ = queue_.lastKey();
+        for (const auto& callback : handlers_[static_cast<std::size_t>(evnt.type)])
+        {
+            callback(evnt);
+        }
+        ++processed_;
+        return true;
+    }
+
+    // Dispatches events up to and including time until, then advances the clock to until.
+    // Events scheduled afterwards for earlier times run at until.
+    void run(std::uint64_t until = std::numeric_limits<std::uint64_t>::max())
+    {
+        if (until == std::numeric_limits<std::uint64_t>::max())
+        {
+            while (step())
+            {
+            }
+            return;
+        }
+        while (!queue_.empty() && queue_.topKey() <= until)
+        {
+            step();
+        }
+        now_ = until > now_ ? until : now_;
+    }
+
+private:
+    radixHeap<simEvent> queue_;
+    std::array<std::vector<handler>, static_cast<std::size_t>(simEventType::count)> handlers_;
+    std::uint64_t now_ = 0;
+    std::size_t processed_ = 0;
+};
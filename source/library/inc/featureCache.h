@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Identifies one indicator series: which data, which indicator, which parameters, which bars
+struct featureKey
+{
+    std::uint64_t dataset;        // datasetHash() of the bars the series was computed on
+    std::string indicator;        // e.g. "sma"
+    std::vector<double> params;   // e.g. {20}
+    std::string timeframe;        // e.g. "1m"
+
+    // Stable textual form; hashed into the on-disk file name and stored in the file
+    std::string canonical() const;
+};
+
+// Content-addressed cache of indicator series shared by every strategy instance in a sweep.
+// Each series is computed at most once per process: concurrent requests for a key that is
+// being computed wait for the first one. With a disk directory configured, series are also
+// persisted in the columnar format and later runs load them instead of recomputing.
+// Resident series are evicted least-recently-used first once the memory budget is exceeded;
+// callers that still hold a series keep it alive.
+class featureCache
+{
+public:
+    using series = std::shared_ptr<const std::vector<double>>;
+
+    struct statistics
+    {
+        std::size_t memoryHits = 0;
+        std::size_t diskHits = 0;
+        std::size_t computed = 0;
+        std::size_t evictions = 0;
+        std::size_t bytesInMemory = 0;
+    };
+
+    explicit featureCache(std::size_t memoryBudgetBytes = 256u << 20, std::filesystem::path diskDirectory = {});
+
+    // Returns the cached series for key, running compute() only if neither memory nor disk has it
+    series get(const featureKey& key, const std::function<std::vector<double>()>& compute);
+
+    void setMemoryBudget(std::size_t bytes);
+    statistics stats() const;
+
+private:
+    struct entry
+    {
+        std::shared_future<series> ready;
+        std::size_t bytes = 0;
+        bool resident = false;   // computed and tracked by the LRU list
+        std::list<std::string>::iterator lruPos;
+    };
+
+    std::filesystem::path pathFor(const std::string& canonicalKey) const;
+    series loadFromDisk(const std::filesystem::path& path, const std::string& canonicalKey) const;
+    void saveToDisk(const std::filesystem::path& path, const std::string& canonicalKey, const std::vector<double>& values) const;
+    void evictLocked();
+
+    std::size_t memoryBudget_;
+    std::filesystem::path diskDirectory_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, entry> entries_;
+    std::list<std::string> lru_;   // most recently used first
+    statistics stats_;
+};
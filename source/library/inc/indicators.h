@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "components.h"
+
+inline std::vector<double> closePrices(const std::vector<MarketData>& bars)
+{
+    std::vector<double> closes;
+    closes.reserve(bars.size());
+    for (const auto& bar : bars)
+    {
+        closes.push_back(bar.close);
+    }
+    return closes;
+}
+
+// Simple moving average; the first period-1 values are NaN
+inline std::vector<double> sma(const std::vector<double>& values, std::size_t period)
+{
+    std::vector<double> out(values.size(), std::numeric_limits<double>::quiet_NaN());
+    if (period == 0 || values.size() < period)
+    {
+        return out;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        sum += values[i];
+        if (i >= period)
+        {
+            sum -= values[i - period];
+        }
+        if (i + 1 >= period)
+        {
+            out[i] = sum / period;
+        }
+    }
+    return out;
+}
+
+// Exponential moving average seeded with the SMA of the first period values
+inline std::vector<double> ema(const std::vector<double>& values, std::size_t period)
+{
+    std::vector<double> out(values.size(), std::numeric_limits<double>::quiet_NaN());
+    if (period == 0 || values.size() < period)
+    {
+        return out;
+    }
+    const double alpha = 2.0 / (period + 1);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < period; ++i)
+    {
+        sum += values[i];
+    }
+    out[period - 1] = sum / period;
+    for (std::size_t i = period; i < values.size(); ++i)
+    {
+        out[i] = alpha * values[i] + (1.0 - alpha) * out[i - 1];
+    }
+    return out;
+}
+
+// Content hash of a dataset, used to key cached features. Two loads of the same file
+// hash equal; any changed or appended bar changes the hash.
+inline std::uint64_t datasetHash(const std::vector<MarketData>& bars)
+{
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](std::uint64_t word) {
+        h ^= word;
+        h *= 0x100000001b3ULL;
+        h ^= h >> 29;
+    };
+    for (const auto& bar : bars)
+    {
+        for (char c : bar.timestamp)
+        {
+            mix(static_cast<unsigned char>(c));
+        }
+        for (double value : {bar.open, bar.high, bar.low, bar.close, bar.volume})
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            mix(bits);
+        }
+    }
+    mix(bars.size());
+    return h;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "components.h"
+#include "localTimeFormatter.h"
+#include "ringBuffer.h"
+
+// One bar as it arrives from the feed, kept trivially copyable so it can go through the ring buffer
+struct liveBar
+{
+    long long timestampMs;
+    double open;
+    double high;
+    double low;
+    double close;
+    double volume;
+    std::chrono::steady_clock::time_point received;  // when the feed thread finished parsing the line
+};
+
+// Collects latency samples without allocating on the hot path and reports percentiles
+class latencyRecorder
+{
+public:
+    explicit latencyRecorder(std::size_t capacity = 1 << 20) { samples_.reserve(capacity); }
+
+    void record(std::chrono::nanoseconds latency)
+    {
+        if (samples_.size() < samples_.capacity())
+        {
+            samples_.push_back(latency.count());
+        }
+    }
+
+    std::size_t count() const { return samples_.size(); }
+
+    // p in [0, 100], result in nanoseconds
+    long long percentile(double p) const;
+
+    void report(std::ostream& out) const;
+
+private:
+    std::vector<long long> samples_;
+};
+
+// Reads bars from a pipe, FIFO or local socket on its own thread and hands them over
+// through a lock-free ring buffer. Lines use the same CSV layout as dataLoader:
+// misc,timestamp(ms),open,high,low,close,volume
+class liveFeed
+{
+public:
+    static constexpr std::size_t RING_CAPACITY = 1 << 16;
+
+    // Takes ownership of an already opened file descriptor
+    explicit liveFeed(int fd);
+    ~liveFeed();
+
+    liveFeed(const liveFeed&) = delete;
+    liveFeed& operator=(const liveFeed&) = delete;
+
+    // Opens a FIFO or regular file for reading, returns -1 on failure
+    static int openPipe(const std::filesystem::path& path);
+
+    // Connects to a local (unix domain) stream socket, returns -1 on failure
+    static int connectSocket(const std::filesystem::path& path);
+
+    void start();
+    void stop();
+
+    // Consumer side, must only be called from one thread
+    bool poll(liveBar& bar) { return ring_->tryPop(bar); }
+
+    // True once the producer hit end of stream and every bar has been consumed
+    bool finished() const { return eof_.load(std::memory_order_acquire) && ring_->sizeApprox() == 0; }
+
+    std::size_t barsReceived() const { return barsReceived_.load(std::memory_order_relaxed); }
+
+private:
+    void readLoop();
+    static bool parseLine(const char* begin, const char* end, liveBar& bar);
+
+    int fd_;
+    std::thread feedThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> eof_{false};
+    std::atomic<std::size_t> barsReceived_{0};
+    std::unique_ptr<spscRingBuffer<liveBar, RING_CAPACITY>> ring_;
+};
+
+// Live counterpart of dataHandler: drains a liveFeed on the calling (strategy) thread and
+// publishes every bar as a marketDataEvent, so strategies written for backtests run unchanged.
+// Tick-to-signal latency is measured from the moment a bar was parsed to the first Signal
+// event published for it.
+class liveDataHandler
+{
+public:
+    liveDataHandler(eventBus& Bus, liveFeed& feed, waitPolicy policy = waitPolicy::adaptive);
+
+    // Runs until the feed is exhausted or stop() is called from another thread
+    void run();
+    void stop() { stopRequested_.store(true, std::memory_order_release); }
+
+    const latencyRecorder& latency() const { return latency_; }
+
+private:
+    void onSignal();
+
+    eventBus& bus;
+    liveFeed& feed_;
+    waitPolicy policy_;
+    latencyRecorder latency_;
+    eventArena arena_;  // per-bar events and signals, rewound after every bar
+    localTimeFormatter formatter_;
+    std::chrono::steady_clock::time_point currentReceived_;
+    bool awaitingSignal_ = false;
+    std::atomic<bool> stopRequested_{false};
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ctime>
+#include <limits>
+#include <string>
+
+// Formats millisecond timestamps like convertTimestamp's default format, but without a
+// localtime call (and the lock inside it) or strftime per row. Time zone offsets only
+// change on 15 minute boundaries, so the offset is looked up once per 15 minute bucket,
+// and the date part is recomputed only when the day changes.
+class localTimeFormatter
+{
+public:
+    // Assigns into out, so a string reused across bars keeps its capacity
+    void format(long long timestampMs, std::string& out)
+    {
+        const long long seconds = floorDiv(timestampMs, 1000);
+        const long long bucket = floorDiv(seconds, 900);
+        if (bucket != bucket_)
+        {
+            std::time_t time = static_cast<std::time_t>(seconds);
+            std::tm local{};
+            localtime_r(&time, &local);
+            offset_ = local.tm_gmtoff;
+            bucket_ = bucket;
+        }
+
+        const long long localSeconds = seconds + offset_;
+        const long long days = floorDiv(localSeconds, 86400);
+        const long long secondOfDay = localSeconds - days * 86400;
+        if (days != days_)
+        {
+            formatDate(days);
+        }
+        writeTwoDigits(text_ + 11, secondOfDay / 3600);
+        writeTwoDigits(text_ + 14, secondOfDay / 60 % 60);
+        writeTwoDigits(text_ + 17, secondOfDay % 60);
+        out.assign(text_, sizeof(text_));
+    }
+
+private:
+    // Days since 1970-01-01 to "YYYY-MM-DD " (proleptic Gregorian)
+    void formatDate(long long days)
+    {
+        const long long z = days + 719468;
+        const long long era = floorDiv(z, 146097);
+        const long long dayOfEra = z - era * 146097;
+        const long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const long long mp = (5 * dayOfYear + 2) / 153;
+        const long long day = dayOfYear - (153 * mp + 2) / 5 + 1;
+        const long long month = mp < 10 ? mp + 3 : mp - 9;
+        const long long year = yearOfEra + era * 400 + (month <= 2);
+
+        writeTwoDigits(text_, year / 100);
+        writeTwoDigits(text_ + 2, year % 100);
+        writeTwoDigits(text_ + 5, month);
+        writeTwoDigits(text_ + 8, day);
+        days_ = days;
+    }
+
+    static void writeTwoDigits(char* out, long long value)
+    {
+        out[0] = static_cast<char>('0' + value / 10);
+        out[1] = static_cast<char>('0' + value % 10);
+    }
+
+    static long long floorDiv(long long a, long long b)
+    {
+        return a / b - (a % b != 0 && (a < 0) != (b < 0));
+    }
+
+    long long bucket_ = std::numeric_limits<long long>::min();
+    long long offset_ = 0;
+    long long days_ = std::numeric_limits<long long>::min();
+    char text_[19] = {'0', '0', '0', '0', '-', '0', '0', '-', '0', '0', ' ', '0', '0', ':', '0', '0', ':', '0', '0'};
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include "components.h"
+
+// Binary cache of parsed market data in the columnar format, so later runs skip CSV parsing.
+// Columns: timestamp (text), open, high, low, close, volume (f64).
+constexpr std::uint32_t MARKET_DATA_TIMESTAMP_WIDTH = 24;
+
+class columnarReader;
+
+bool writeMarketDataCache(const std::filesystem::path& path, const std::vector<MarketData>& bars);
+
+// Whether a loaded file has all six columns with the types and widths above
+bool isMarketDataCache(const columnarReader& in);
+
+// Empty when the file is missing or not a market data cache
+std::vector<MarketData> readMarketDataCache(const std::filesystem::path& path);
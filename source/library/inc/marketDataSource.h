@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "columnar.h"
+#include "compressedLoader.h"
+#include "components.h"
+#include "ringBuffer.h"
+
+// Pull interface for histories that should not, or cannot, be held in memory at once.
+// Sources hand out bars in file order, a chunk at a time.
+class marketDataSource
+{
+public:
+    virtual ~marketDataSource() = default;
+
+    // Replaces chunk's contents with up to maxBars next bars. Bars already in chunk are
+    // overwritten in place, so a recycled chunk does not allocate again. Returns false
+    // once the source is exhausted.
+    virtual bool nextChunk(std::vector<MarketData>& chunk, std::size_t maxBars) = 0;
+
+    // Once nextChunk returned false: whether the whole source was read
+    virtual bool good() const = 0;
+};
+
+// dataLoader's CSV layout, plain, gzip or zstd (see csvBlockReader)
+class csvMarketDataSource : public marketDataSource
+{
+public:
+    explicit csvMarketDataSource(const std::filesystem::path& path) : reader_(path, 2) {}
+
+    bool nextChunk(std::vector<MarketData>& chunk, std::size_t maxBars) override;
+    bool good() const override { return reader_.good(); }
+
+    std::size_t malformedLines() const { return malformedLines_; }
+
+private:
+    // Next complete line without its '\n'; false at the end of the file
+    bool nextLine(const char*& begin, const char*& end);
+
+    csvBlockReader reader_;
+    std::string block_;
+    std::size_t pos_ = 0;     // first unread byte of block_
+    std::string partial_;     // line split across two blocks
+    bool headerSkipped_ = false;
+    bool finished_ = false;
+    std::size_t malformedLines_ = 0;
+};
+
+// Market data cache files (writeMarketDataCache), read a chunk of rows at a time
+class cacheMarketDataSource : public marketDataSource
+{
+public:
+    explicit cacheMarketDataSource(const std::filesystem::path& path);
+
+    bool nextChunk(std::vector<MarketData>& chunk, std::size_t maxBars) override;
+    bool good() const override { return good_; }
+
+private:
+    columnarStreamReader reader_;
+    int timestamp_, open_, high_, low_, close_, volume_;
+    std::vector<std::vector<char>> columns_;
+    bool good_ = false;
+};
+
+// Loads chunks from a source on a background thread while the caller replays earlier
+// ones. Exactly window chunk buffers circulate between the loader and the caller, so at
+// most window * chunkBars bars are in memory however large the source is, and the first
+// chunk can be replayed while the rest is still loading.
+class chunkReadAhead
+{
+public:
+    chunkReadAhead(marketDataSource& source, std::size_t chunkBars, std::size_t window);
+    ~chunkReadAhead();
+
+    chunkReadAhead(const chunkReadAhead&) = delete;
+    chunkReadAhead& operator=(const chunkReadAhead&) = delete;
+
+    // Next chunk in order, nullptr at the end. Valid until the following call.
+    const std::vector<MarketData>* next();
+
+private:
+    void loadLoop();
+
+    marketDataSource& source_;
+    std::size_t chunkBars_;
+    boundedQueue<std::vector<MarketData>> free_;
+    boundedQueue<std::vector<MarketData>> loaded_;
+    std::vector<MarketData> current_;
+    bool holding_ = false;
+    std::thread loader_;
+};
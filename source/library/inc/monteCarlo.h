@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rng.h"
+
+struct monteCarloConfig
+{
+    std::size_t resamples = 10000;
+    std::uint64_t seed = 0x5EEDC0DE;
+    std::size_t numThreads = std::thread::hardware_concurrency();
+    std::size_t blockLength = 20;   // bars per block for the block bootstrap
+};
+
+// One value per resample, stored in resample order so results do not depend on threading
+struct monteCarloResult
+{
+    std::vector<double> totalReturn;   // compounded return of the resampled path
+    std::vector<double> maxDrawdown;   // largest peak-to-trough loss, as a positive fraction
+
+    static double percentile(const std::vector<double>& values, double p);
+    static double mean(const std::vector<double>& values);
+    static double stddev(const std::vector<double>& values);
+
+    void print(const std::string& title, std::ostream& out = std::cout) const;
+};
+
+// Robustness checks for a finished backtest. Inputs are simple returns (0.01 == +1%).
+// Resample i always draws from Philox stream (seed, i), so a result is reproducible
+// for a given seed regardless of thread count.
+class monteCarloEngine
+{
+public:
+    explicit monteCarloEngine(monteCarloConfig config = {}) : config_(config) {}
+
+    // Randomly reorders the trades. Total return is order independent, the drawdown
+    // distribution shows how much of the backtest's drawdown was luck of ordering.
+    monteCarloResult tradeShuffle(const std::vector<double>& tradeReturns) const;
+
+    // Circular block bootstrap of per-bar returns, keeps short-range autocorrelation
+    monteCarloResult blockBootstrap(const std::vector<double>& barReturns) const;
+
+    // Baseline: numTrades entries at random bars, each held for holdBars bars
+    monteCarloResult randomEntry(const std::vector<double>& closes, std::size_t numTrades, std::size_t holdBars) const;
+
+private:
+    // Calls fill(rng, path) once per resample to build a path of log returns and
+    // summarises it; resamples are spread over a ThreadPool in contiguous chunks
+    template <class Fill>
+    monteCarloResult run(std::size_t pathLength, Fill fill) const;
+
+    monteCarloConfig config_;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "components.h"
+#include "marketDataSource.h"
+
+inline signalMap toSignalMap(const tradeSignal& sig)
+{
+    switch (sig.type)
+    {
+    case 1:
+        return {{"type",1}, {"fraction",sig.fraction}, {"closePrice",sig.closePrice}};
+    case 2:
+        return {{"type",2}, {"fraction",sig.fraction}, {"closePrice",sig.closePrice}};
+    default:
+        return {{"type",0}, {"closePrice",sig.closePrice}};
+    }
+}
+
+// CRTP base for strategies that run in backtestPipeline. Derived implements
+//     tradeSignal signal(const MarketData& bar);
+// and the call is resolved at compile time, so it can be inlined into the replay loop.
+template <class Derived>
+class staticStrategy
+{
+public:
+    tradeSignal onBar(const MarketData& bar) { return static_cast<Derived*>(this)->signal(bar); }
+};
+
+// Broker for the static pipeline: same portfolio rules as broker::onSignal, no event bus
+class staticBroker
+{
+public:
+    void onSignal(const tradeSignal& sig)
+    {
+        if (sig.type == 1 && !book_.inPosition)
+        {
+            book_.buy(sig.fraction, sig.closePrice);
+        }
+        else if (sig.type == 2 && book_.inPosition)
+        {
+            book_.sell(sig.fraction, sig.closePrice);
+        }
+    }
+
+    const portfolio& book() const { return book_; }
+
+private:
+    portfolio book_;
+};
+
+// Compile-time composition of data, strategy and broker into one monomorphised loop.
+// Use it for sweeps and other hot paths; the eventBus path stays available for plugins
+// that are only known at run time.
+template <class Strategy, class Broker>
+class backtestPipeline
+{
+    static_assert(std::is_same<decltype(std::declval<Strategy&>().onBar(std::declval<const MarketData&>())), tradeSignal>::value,
+                  "Strategy must provide tradeSignal onBar(const MarketData&), e.g. by deriving from staticStrategy");
+    static_assert(std::is_void<decltype(std::declval<Broker&>().onSignal(std::declval<const tradeSignal&>()))>::value,
+                  "Broker must provide void onSignal(const tradeSignal&)");
+
+public:
+    backtestPipeline(Strategy& strategy, Broker& brkr) : strategy_(strategy), broker_(brkr) {}
+
+    void run(const std::vector<MarketData>& bars)
+    {
+        for (const auto& bar : bars)
+        {
+            broker_.onSignal(strategy_.onBar(bar));
+        }
+    }
+
+    // Replays bars straight from a columnar view, e.g. an attached sharedDataset
+    void run(const marketDataView& view)
+    {
+        MarketData bar;
+        for (std::size_t i = 0; i < view.size; ++i)
+        {
+            view.fill(i, bar);
+            broker_.onSignal(strategy_.onBar(bar));
+        }
+    }
+
+    // Streams bars from a source, loading ahead with at most windowChunks chunks in memory
+    void run(marketDataSource& source, std::size_t chunkBars = 1 << 16, std::size_t windowChunks = 3)
+    {
+        chunkReadAhead chunks(source, chunkBars, windowChunks);
+        while (const std::vector<MarketData>* chunk = chunks.next())
+        {
+            for (const auto& bar : *chunk)
+            {
+                broker_.onSignal(strategy_.onBar(bar));
+            }
+        }
+    }
+
+    // Replays the handler's history from its current position, leaving the cursor at the end
+    void run(dataHandler& handler)
+    {
+        const auto& bars = handler.historicalMarketData;
+        for (; handler.currentDataIndex < bars.size(); ++handler.currentDataIndex)
+        {
+            broker_.onSignal(strategy_.onBar(bars[handler.currentDataIndex]));
+        }
+    }
+
+private:
+    Strategy& strategy_;
+    Broker& broker_;
+};
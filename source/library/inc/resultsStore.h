@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "columnar.h"
+
+// One append-only columnar results file with double buffering: rows go into the active
+// buffer; a full buffer is swapped with the spare and handed to the background writer.
+// Producers only wait when both buffers are full, which bounds memory to two chunks.
+class resultsTable
+{
+public:
+    resultsTable(const std::filesystem::path& path, const std::vector<columnSpec>& schema, std::size_t rowsPerChunk);
+
+    const std::string& name() const { return name_; }
+
+private:
+    friend class resultsWriter;
+
+    struct buffer
+    {
+        std::vector<std::vector<char>> columns;
+        std::size_t rows = 0;
+    };
+
+    std::string name_;
+    columnarWriter file_;
+    std::size_t rowsPerChunk_;
+    buffer active_;
+    buffer spare_;
+    bool spareBusy_ = false;    // spare_ is queued for or being written by the writer thread
+    std::mutex mutex_;
+    std::condition_variable spareFree_;
+};
+
+// Streams fills, positions, equity points and per-configuration metrics of a run into
+// <directory>/<table>.qcol through a background writer thread. Safe to call from several
+// simulation threads at once.
+class resultsWriter
+{
+public:
+    explicit resultsWriter(const std::filesystem::path& directory, std::size_t rowsPerChunk = 1 << 16);
+    ~resultsWriter();
+
+    resultsWriter(const resultsWriter&) = delete;
+    resultsWriter& operator=(const resultsWriter&) = delete;
+
+    bool good() const { return good_; }
+
+    // side: 1 buy, 2 sell (same codes as signals)
+    void recordFill(std::string_view timestamp, int side, double fraction, double price, double cash);
+    void recordPosition(std::string_view timestamp, double asset, double cash, bool inPosition);
+    void recordEquity(std::string_view timestamp, double equity);
+    void recordMetric(std::int64_t configId, std::string_view metric, double value);
+
+    // Writes out partially filled buffers and waits until everything is on disk
+    void flush();
+
+    // flush() and stop the writer thread; called by the destructor
+    void close();
+
+private:
+    static constexpr std::uint32_t TIMESTAMP_WIDTH = 24;
+    static constexpr std::uint32_t METRIC_WIDTH = 32;
+
+    // Each value points to one value of the matching column's width
+    void append(resultsTable& table, std::initializer_list<const void*> values);
+    void handOver(resultsTable& table, std::unique_lock<std::mutex>& lock);
+    void writerLoop();
+
+    bool good_ = true;
+    std::unique_ptr<resultsTable> fills_;
+    std::unique_ptr<resultsTable> positions_;
+    std::unique_ptr<resultsTable> equity_;
+    std::unique_ptr<resultsTable> metrics_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::deque<resultsTable*> queue_;
+    bool stopping_ = false;
+    std::thread writerThread_;
+};
+
+// Loads results written by resultsWriter back as columns
+class resultsReader
+{
+public:
+    explicit resultsReader(const std::filesystem::path& directory) : directory_(directory) {}
+
+    // table is one of "fills", "positions", "equity", "metrics"
+    columnarReader table(const std::string& table) const { return columnarReader(directory_ / (table + ".qcol")); }
+
+    // Writes one table as CSV with a header row
+    bool exportCsv(const std::string& table, const std::filesystem::path& csvPath) const;
+
+private:
+    std::filesystem::path directory_;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Hint to the CPU that we are spinning on a shared location
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// How a consumer waits when its queue is empty
+// busyPoll: spin on the queue, lowest latency but burns a full core
+// adaptive: spin for a while, then yield, then back off with short sleeps
+enum class waitPolicy { busyPoll, adaptive };
+
+class backoff
+{
+public:
+    explicit backoff(waitPolicy policy) : policy_(policy) {}
+
+    // Called each time the consumer finds nothing to do
+    void pause()
+    {
+        if (policy_ == waitPolicy::busyPoll || spins_ < SPIN_LIMIT)
+        {
+            ++spins_;
+            cpuRelax();
+        }
+        else if (spins_ < YIELD_LIMIT)
+        {
+            ++spins_;
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    // Called each time the consumer found work
+    void reset() { spins_ = 0; }
+
+private:
+    static constexpr unsigned SPIN_LIMIT = 4096;
+    static constexpr unsigned YIELD_LIMIT = SPIN_LIMIT + 256;
+
+    waitPolicy policy_;
+    unsigned spins_ = 0;
+};
+
+// Lock-free single-producer/single-consumer ring buffer.
+// Exactly one thread may call tryPush and exactly one (other) thread may call tryPop.
+// Capacity must be a power of two.
+template <typename T, std::size_t Capacity>
+class spscRingBuffer
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Ring buffer items are copied as plain memory");
+
+public:
+    bool tryPush(const T& item)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tailCache_ == Capacity)
+        {
+            // Looks full from our cached view, refresh it from the consumer
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head - tailCache_ == Capacity)
+            {
+                return false;
+            }
+        }
+        slots_[head & MASK] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == headCache_)
+        {
+            // Looks empty from our cached view, refresh it from the producer
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail == headCache_)
+            {
+                return false;
+            }
+        }
+        item = slots_[tail & MASK];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only exact when called while neither side is running
+    std::size_t sizeApprox() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Producer and consumer indices live on separate cache lines so the two threads
+    // do not invalidate each other on every operation
+    alignas(CACHE_LINE) std::atomic<std::size_t> head_{0};
+    std::size_t tailCache_ = 0;   // producer's last view of tail_
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> tail_{0};
+    std::size_t headCache_ = 0;   // consumer's last view of head_
+
+    alignas(CACHE_LINE) T slots_[Capacity];
+};
+
+// Blocking bounded queue for large items (blocks of megabytes), where one lock per item is
+// noise next to the work done on it. push() waits while the queue is full, so a fast stage
+// cannot run ahead of a slow one by more than Capacity items. close() wakes everyone:
+// push() then fails and pop() drains what is left before failing.
+template <typename T>
+class boundedQueue
+{
+public:
+    explicit boundedQueue(std::size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        if (closed_)
+        {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty())
+        {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
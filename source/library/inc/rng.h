@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy
+// as 1, 2, 3"). Output block i of stream s under key k is a pure function of (k, s, i), so
+// any number of independent, reproducible streams can be created without sharing state.
+// Satisfies UniformRandomBitGenerator, so it works with the <random> distributions.
+class philoxRng
+{
+public:
+    using result_type = std::uint32_t;
+
+    philoxRng(std::uint64_t seed = 0, std::uint64_t stream = 0)
+        : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+          counter_{0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        if (index_ == 4)
+        {
+            buffer_ = block(counter_, key_);
+            increment();
+            index_ = 0;
+        }
+        return buffer_[index_++];
+    }
+
+    // Uniform double in [0, 1) with 53 random bits
+    double uniform()
+    {
+        std::uint64_t bits = (static_cast<std::uint64_t>((*this)()) << 32) | (*this)();
+        return (bits >> 11) * 0x1.0p-53;
+    }
+
+    // Uniform integer in [0, bound), unbiased (Lemire's multiply and reject)
+    std::uint32_t bounded(std::uint32_t bound)
+    {
+        std::uint64_t product = static_cast<std::uint64_t>((*this)()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound)
+        {
+            std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold)
+            {
+                product = static_cast<std::uint64_t>((*this)()) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    // The raw keyed bijection: ten Philox rounds over a 128-bit counter
+    static std::array<std::uint32_t, 4> block(std::array<std::uint32_t, 4> ctr, std::array<std::uint32_t, 2> key)
+    {
+        for (int round = 0; round < 10; ++round)
+        {
+            if (round > 0)
+            {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            std::uint64_t p0 = static_cast<std::uint64_t>(M0) * ctr[0];
+            std::uint64_t p1 = static_cast<std::uint64_t>(M1) * ctr[2];
+            ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+        }
+        return ctr;
+    }
+
+private:
+    static constexpr std::uint32_t M0 = 0xD2511F53;
+    static constexpr std::uint32_t M1 = 0xCD9E8D57;
+    static constexpr std::uint32_t W0 = 0x9E3779B9;
+    static constexpr std::uint32_t W1 = 0xBB67AE85;
+
+    // The low 64 bits of the counter index blocks inside a stream, the high 64 bits are the stream id
+    void increment()
+    {
+        if (++counter_[0] == 0)
+        {
+            ++counter_[1];
+        }
+    }
+
+    std::array<std::uint32_t, 2> key_;
+    std::array<std::uint32_t, 4> counter_;
+    std::array<std::uint32_t, 4> buffer_{};
+    int index_ = 4;
+};
+
+// Process-wide source of reproducible random streams. Everything that needs randomness
+// (strategies, Monte Carlo resamples) derives its generator from one global seed plus a
+// stream id, so a run is repeatable given the seed.
+class rngService
+{
+public:
+    // Also restarts sequential stream numbering, call before constructing strategies
+    static void setSeed(std::uint64_t seed)
+    {
+        seed_.store(seed, std::memory_order_relaxed);
+        nextStream_.store(0, std::memory_order_relaxed);
+    }
+
+    static std::uint64_t seed() { return seed_.load(std::memory_order_relaxed); }
+
+    // Explicitly numbered stream, e.g. one per resample
+    static philoxRng stream(std::uint64_t id) { return philoxRng(seed(), id); }
+
+    // Next stream in creation order; deterministic as long as creation order is
+    static philoxRng next() { return stream(nextStream_.fetch_add(1, std::memory_order_relaxed)); }
+
+    // Lazily created generator owned by the calling thread
+    static philoxRng& threadLocal()
+    {
+        static thread_local philoxRng generator = next();
+        return generator;
+    }
+
+private:
+    inline static std::atomic<std::uint64_t> seed_{0x5EEDC0DE};
+    inline static std::atomic<std::uint64_t> nextStream_{0};
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "eventScheduler.h"
+#include "pipeline.h"
+#include "rng.h"
+
+// One-way delays of the simulated messages
+struct latencyModel
+{
+    std::chrono::nanoseconds marketData{0};   // exchange -> strategy, bar data
+    std::chrono::nanoseconds order{0};        // strategy -> exchange
+    std::chrono::nanoseconds ack{0};          // exchange -> strategy, order acknowledged
+    std::chrono::nanoseconds fill{0};         // exchange -> strategy, execution report
+    std::chrono::nanoseconds jitter{0};       // extra delay per message, uniform in [0, jitter)
+};
+
+// Backtest on the eventScheduler: bars close at the exchange every barInterval, reach the
+// strategy after the market data latency, and the resulting orders travel to the exchange,
+// are filled there at the price current on arrival, and are acknowledged and reported
+// back with their own latencies. With all latencies zero this trades like backtestPipeline.
+//
+// Strategy is a staticStrategy (tradeSignal onBar(const MarketData&)). While an order is
+// in flight further signals are ignored, as the strategy does not know its position yet.
+// Jitter comes from a philoxRng stream, so runs are reproducible for a given seed.
+// Extra handlers and timers can be added through scheduler().
+template <class Strategy>
+class scheduledBacktest
+{
+public:
+    scheduledBacktest(Strategy& strategy, const latencyModel& latency, std::chrono::nanoseconds barInterval = std::chrono::minutes(1))
+        : strategy_(strategy), latency_(latency), barInterval_(static_cast<std::uint64_t>(barInterval.count())), rng_(rngService::next())
+    {
+        scheduler_.on(simEventType::bar, [this](const simEvent& evnt) { onBar(evnt); });
+        scheduler_.on(simEventType::marketData, [this](const simEvent& evnt) { onMarketData(evnt); });
+        scheduler_.on(simEventType::order, [this](const simEvent& evnt) { onOrder(evnt); });
+        scheduler_.on(simEventType::ack, [this](const simEvent&) { ++acks_; });
+        scheduler_.on(simEventType::fill, [this](const simEvent& evnt) { onFill(evnt); });
+    }
+
+    // Bars are scheduled one at a time as the previous one closes, so the queue only holds
+    // messages in flight
+    void run(const std::vector<MarketData>& bars)
+    {
+        bars_ = &bars;
+        if (!bars.empty())
+        {
+            simEvent first;
+            first.type = simEventType::bar;
+            scheduler_.at(scheduler_.now(), first);
+        }
+        scheduler_.run();
+        bars_ = nullptr;
+    }
+
+    eventScheduler& scheduler() { return scheduler_; }
+    const portfolio& book() const { return book_; }
+    std::size_t ordersSent() const { return ordersSent_; }
+    std::size_t acks() const { return acks_; }
+
+private:
+    std::chrono::nanoseconds delay(std::chrono::nanoseconds base)
+    {
+        if (latency_.jitter.count() <= 0)
+        {
+            return base;
+        }
+        return base + std::chrono::nanoseconds(static_cast<std::int64_t>(rng_.uniform() * latency_.jitter.count()));
+    }
+
+    // Bar events carry the bar index in id
+    void onBar(const simEvent& evnt)
+    {
+        lastBar_ = &(*bars_)[evnt.id];
+
+        simEvent data = evnt;
+        data.type = simEventType::marketData;
+        scheduler_.after(delay(latency_.marketData), data);
+
+        if (evnt.id + 1 < bars_->size())
+        {
+            simEvent next;
+            next.type = simEventType::bar;
+            next.id = evnt.id + 1;
+            scheduler_.after(std::chrono::nanoseconds(barInterval_), next);
+        }
+    }
+
+    void onMarketData(const simEvent& evnt)
+    {
+        const tradeSignal sig = strategy_.onBar((*bars_)[evnt.id]);
+        if (orderInFlight_ || !((sig.type == 1 && !book_.inPosition) || (sig.type == 2 && book_.inPosition)))
+        {
+            return;
+        }
+        simEvent order;
+        order.type = simEventType::order;
+        order.side = static_cast<std::uint8_t>(sig.type);
+        order.id = ordersSent_++;
+        order.fraction = sig.fraction;
+        scheduler_.after(delay(latency_.order), order);
+        orderInFlight_ = true;
+    }
+
+    // Exchange side: market orders fill at the last close the exchange has seen
+    void onOrder(const simEvent& evnt)
+    {
+        simEvent ack = evnt;
+        ack.type = simEventType::ack;
+        scheduler_.after(delay(latency_.ack), ack);
+
+        simEvent fill = evnt;
+        fill.type = simEventType::fill;
+        fill.price = lastBar_ ? lastBar_->close : 0.0;
+        scheduler_.after(delay(latency_.fill), fill);
+    }
+
+    void onFill(const simEvent& evnt)
+    {
+        if (evnt.side == 1)
+        {
+            book_.buy(evnt.fraction, evnt.price);
+        }
+        else
+        {
+            book_.sell(evnt.fraction, evnt.price);
+        }
+        orderInFlight_ = false;
+    }
+
+    Strategy& strategy_;
+    latencyModel latency_;
+    std::uint64_t barInterval_;
+    philoxRng rng_;
+    eventScheduler scheduler_;
+    const std::vector<MarketData>* bars_ = nullptr;
+    const MarketData* lastBar_ = nullptr;
+    portfolio book_;
+    bool orderInFlight_ = false;
+    std::size_t ordersSent_ = 0;
+    std::size_t acks_ = 0;
+};
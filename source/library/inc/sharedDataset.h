@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "components.h"
+
+// Market data published once into a named POSIX shared memory segment and attached
+// read-only by any number of backtest processes. The segment holds a small catalog and
+// one columnar block per symbol, so attaching is an mmap and no process parses or copies
+// the data; the pages are shared, so memory stays flat as processes are added.
+//
+// Names follow shm_open rules: a leading '/' is added if missing, and macOS limits them
+// to 31 characters.
+
+struct sharedDatasetHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t datasetCount;
+    std::uint64_t segmentSize;
+    std::atomic<std::uint32_t> ready;   // set last by the publisher
+    std::uint32_t reserved;
+};
+
+struct sharedDatasetEntry
+{
+    char symbol[32];
+    std::uint64_t rowCount;
+    std::uint32_t timestampWidth;
+    std::uint32_t reserved;
+    std::uint64_t timestampOffset;   // offsets are from the start of the segment
+    std::uint64_t openOffset;
+    std::uint64_t highOffset;
+    std::uint64_t lowOffset;
+    std::uint64_t closeOffset;
+    std::uint64_t volumeOffset;
+};
+
+// Publisher side: stage one or more symbols, then publish() them as one segment
+class sharedDatasetServer
+{
+public:
+    void add(const std::string& symbol, const std::vector<MarketData>& bars);
+
+    // Takes the columns of a writeMarketDataCache file as they are, without parsing
+    bool addCache(const std::string& symbol, const std::filesystem::path& cachePath);
+
+    // Creates (replacing any previous) segment. It stays after this process exits,
+    // until sharedDataset::remove is called.
+    bool publish(const std::string& name) const;
+
+private:
+    struct staged
+    {
+        std::string symbol;
+        std::size_t rows = 0;
+        std::vector<char> timestamps;
+        std::vector<double> open, high, low, close, volume;
+    };
+
+    std::vector<staged> datasets_;
+};
+
+// Client side: read-only attachment to a published segment
+class sharedDataset
+{
+public:
+    explicit sharedDataset(const std::string& name);
+    ~sharedDataset();
+
+    sharedDataset(const sharedDataset&) = delete;
+    sharedDataset& operator=(const sharedDataset&) = delete;
+
+    bool good() const { return base_ != nullptr; }
+    std::vector<std::string> symbols() const;
+
+    // Empty view (size 0) when the symbol is not in the catalog
+    marketDataView find(const std::string& symbol) const;
+
+    static bool remove(const std::string& name);
+
+private:
+    const char* base_ = nullptr;
+    std::size_t size_ = 0;
+};
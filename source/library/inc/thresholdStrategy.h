@@ -0,0 +1,82 @@
+#pragma once
+
+#include "components.h"
+#include "pipeline.h"
+#include "rng.h"
+
+// Decision rule shared by the event-driven and the compile-time ThresholdStrategy
+inline tradeSignal thresholdRule(const MarketData& marketData, philoxRng& rng)
+{
+    // Random number in {0, 0.5, 1, 1.5}
+    double randNum = rng.bounded(4)/2.0;
+
+    if (marketData.close > marketData.close*randNum) {
+        return {1, 0.95, marketData.close};
+    } else if (marketData.close < marketData.close*randNum) {
+        return {2, 1.0, marketData.close};
+    } else {
+        return {0, 0, marketData.close};
+    }
+}
+
+class ThresholdStrategy : public strategyEngine {
+public:
+    // Constructor
+    ThresholdStrategy(eventBus& Bus, double buyThreshold, double sellThreshold)
+        : strategyEngine(Bus), buyThreshold_(buyThreshold), sellThreshold_(sellThreshold)
+    {
+        // MarketData events arrive through the subscription made by strategyEngine
+        std::cout << "Strategy Subscribed to MarketData events" << std::endl;
+    }
+
+    // Function to handle MarketData events
+    void onMarketData(const marketDataEvent& evnt) override
+    {
+        std::cout << "Received MarketData event for timestamp: " << evnt.timestamp << std::endl;
+        // Extract MarketData and generate signals
+        const MarketData& marketData = extractMarketData(evnt);
+
+        signalEvent sigEvent{marketData.timestamp, evaluate(marketData)};
+
+        bus.publish(sigEvent);
+    }
+
+    // The threshold strategy logic as a map, for plugins; replays publish evaluate() directly
+    signalMap generateSignal(const MarketData& marketData) override
+    {
+        return toSignalMap(evaluate(marketData));
+    }
+
+    // Override to change the decision; what onMarketData publishes for every bar
+    virtual tradeSignal evaluate(const MarketData& marketData)
+    {
+        tradeSignal sig = thresholdRule(marketData, rng);
+
+        if (sig.type == 1) {
+            std::cout << "Generated Buy signal for timestamp: " << marketData.timestamp << std::endl;
+        } else if (sig.type == 2) {
+            std::cout << "Generated Sell signal for timestamp: " << marketData.timestamp << std::endl;
+        } else {
+            std::cout << "No signal generated for timestamp: " << marketData.timestamp << std::endl;
+        }
+        return sig;
+    }
+
+private:
+    double buyThreshold_;
+    double sellThreshold_;
+};
+
+// ThresholdStrategy for backtestPipeline: identical rule, resolved at compile time
+class staticThresholdStrategy : public staticStrategy<staticThresholdStrategy> {
+public:
+    staticThresholdStrategy(double buyThreshold, double sellThreshold)
+        : buyThreshold_(buyThreshold), sellThreshold_(sellThreshold), rng(rngService::next()) {}
+
+    tradeSignal signal(const MarketData& marketData) { return thresholdRule(marketData, rng); }
+
+private:
+    double buyThreshold_;
+    double sellThreshold_;
+    philoxRng rng;
+};
@@ -0,0 +1,127 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+#include "checkpoint.h"
+
+namespace
+{
+constexpr char CHECKPOINT_MAGIC[8] = {'Q', 'C', 'H', 'K', 'P', 'T', '0', '1'};
+constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+}
+
+backtestCheckpoint backtestCheckpoint::capture(const dataHandler& handler, const strategyEngine& strategy, const broker& brkr)
+{
+    backtestCheckpoint snapshot;
+    snapshot.cursor_ = handler.currentDataIndex;
+    if (handler.currentDataIndex > 0 && handler.currentDataIndex <= handler.historicalMarketData.size())
+    {
+        snapshot.lastTimestamp_ = handler.historicalMarketData[handler.currentDataIndex - 1].timestamp;
+    }
+    checkpointWriter state;
+    strategy.saveState(state);
+    snapshot.strategyState_ = state.release();
+    snapshot.book_ = brkr.book();
+    snapshot.valid_ = true;
+    return snapshot;
+}
+
+bool backtestCheckpoint::restore(dataHandler& handler, strategyEngine& strategy, broker& brkr) const
+{
+    if (!valid_)
+    {
+        std::cerr << "Cannot restore an empty checkpoint" << std::endl;
+        return false;
+    }
+    // A handler without a history replays from a view or a source, which it cannot check here
+    const auto& bars = handler.historicalMarketData;
+    if (!bars.empty() && (cursor_ > bars.size() || (cursor_ > 0 && bars[cursor_ - 1].timestamp != lastTimestamp_)))
+    {
+        std::cerr << "Checkpoint stopped after bar " << cursor_ << " (" << lastTimestamp_
+                  << "), which is not in the loaded history" << std::endl;
+        return false;
+    }
+
+    checkpointReader state(strategyState_.data(), strategyState_.size());
+    if (!strategy.loadState(state) || !state.good() || !state.atEnd())
+    {
+        std::cerr << "Checkpoint strategy state does not match this strategy" << std::endl;
+        return false;
+    }
+    brkr.setBook(book_);
+    handler.currentDataIndex = cursor_;
+    return true;
+}
+
+bool backtestCheckpoint::save(const std::filesystem::path& path) const
+{
+    checkpointWriter out;
+    out.put(CHECKPOINT_MAGIC);
+    out.put(CHECKPOINT_VERSION);
+    out.put(cursor_);
+    out.putString(lastTimestamp_);
+    out.put(book_.cash);
+    out.put(book_.asset);
+    out.put<std::uint8_t>(book_.inPosition ? 1 : 0);
+    out.put<std::uint64_t>(book_.trades);
+    out.putString(std::string_view(strategyState_.data(), strategyState_.size()));
+
+    std::filesystem::path tmp = path;
+    tmp += "." + std::to_string(::getpid()) + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(out.bytes().data(), static_cast<std::streamsize>(out.bytes().size()));
+        if (!file)
+        {
+            std::cerr << "Error writing checkpoint: " << tmp << std::endl;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::cerr << "Error writing checkpoint: " << path << " (" << ec.message() << ")" << std::endl;
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+backtestCheckpoint backtestCheckpoint::load(const std::filesystem::path& path)
+{
+    backtestCheckpoint snapshot;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return snapshot;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    checkpointReader in(bytes.data(), bytes.size());
+    char magic[8] = {};
+    std::uint32_t version = 0;
+    std::uint8_t inPosition = 0;
+    std::uint64_t trades = 0;
+    std::string strategyState;
+    in.get(magic);
+    in.get(version);
+    in.get(snapshot.cursor_);
+    in.getString(snapshot.lastTimestamp_);
+    in.get(snapshot.book_.cash);
+    in.get(snapshot.book_.asset);
+    in.get(inPosition);
+    in.get(trades);
+    in.getString(strategyState);
+    if (!in.good() || !in.atEnd() || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_VERSION)
+    {
+        std::cerr << "Not a checkpoint file: " << path << std::endl;
+        return backtestCheckpoint();
+    }
+    snapshot.book_.inPosition = inPosition != 0;
+    snapshot.book_.trades = trades;
+    snapshot.strategyState_.assign(strategyState.begin(), strategyState.end());
+    snapshot.valid_ = true;
+    return snapshot;
+}
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "columnar.h"
+
+namespace
+{
+// Reads the metadata that follows the column descriptions in version 2 files and skips its
+// padding. offset is where it starts and is moved past it; false when it does not fit the file.
+bool readMetadata(FILE* file, const columnarFileHeader& header, std::uint64_t fileSize, std::uint64_t& offset, std::string& metadata)
+{
+    if (header.version < COLUMNAR_VERSION_METADATA)
+    {
+        return true;
+    }
+    columnarMetadataHeader meta{};
+    if (std::fread(&meta, sizeof(meta), 1, file) != 1)
+    {
+        return false;
+    }
+    offset += sizeof(meta);
+    if (offset > fileSize || meta.size > fileSize - offset)
+    {
+        return false;
+    }
+    metadata.resize(meta.size);
+    if (meta.size > 0 && std::fread(&metadata[0], 1, meta.size, file) != meta.size)
+    {
+        return false;
+    }
+    offset += (meta.size + 7) / 8 * 8;
+    return std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0;
+}
+}
+
+columnarWriter::columnarWriter(const std::filesystem::path& path, const std::vector<columnSpec>& schema, const std::string& metadata)
+    : schema_(schema)
+{
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+    {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return;
+    }
+
+    columnarFileHeader header{};
+    std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC));
+    header.version = metadata.empty() ? 1 : COLUMNAR_VERSION_METADATA;
+    header.columnCount = static_cast<std::uint32_t>(schema_.size());
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    for (const auto& col : schema_)
+    {
+        columnarColumnDesc desc{};
+        std::strncpy(desc.name, col.name.c_str(), COLUMNAR_NAME_SIZE - 1);
+        desc.type = col.type;
+        desc.width = col.width;
+        std::fwrite(&desc, sizeof(desc), 1, file_);
+    }
+
+    if (!metadata.empty())
+    {
+        columnarMetadataHeader meta{metadata.size()};
+        const char padding[8] = {};
+        std::fwrite(&meta, sizeof(meta), 1, file_);
+        std::fwrite(metadata.data(), 1, metadata.size(), file_);
+        std::fwrite(padding, 1, (8 - metadata.size() % 8) % 8, file_);
+    }
+}
+
+columnarWriter::~columnarWriter()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+    }
+}
+
+bool columnarWriter::appendChunk(const std::vector<const void*>& columns, std::uint64_t rowCount)
+{
+    if (!file_ || columns.size() != schema_.size())
+    {
+        return false;
+    }
+    columnarChunkHeader header{rowCount};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    for (std::size_t i = 0; i < columns.size() && ok; ++i)
+    {
+        ok = std::fwrite(columns[i], schema_[i].width, rowCount, file_) == rowCount;
+    }
+    return ok;
+}
+
+void columnarWriter::flush()
+{
+    if (file_)
+    {
+        std::fflush(file_);
+    }
+}
+
+columnarReader::columnarReader(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const std::uint64_t fileSize = std::filesystem::file_size(path, ec);
+    FILE* file = ec ? nullptr : std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return;
+    }
+
+    columnarFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0)
+    {
+        std::cerr << "Not a columnar file: " << path << std::endl;
+        std::fclose(file);
+        return;
+    }
+
+    for (std::uint32_t i = 0; i < header.columnCount; ++i)
+    {
+        columnarColumnDesc desc{};
+        if (std::fread(&desc, sizeof(desc), 1, file) != 1)
+        {
+            std::fclose(file);
+            return;
+        }
+        desc.name[COLUMNAR_NAME_SIZE - 1] = '\0';
+        schema_.push_back({desc.name, desc.type, desc.width});
+    }
+    std::uint64_t offset = sizeof(header) + header.columnCount * sizeof(columnarColumnDesc);
+    if (!readMetadata(file, header, fileSize, offset, metadata_))
+    {
+        std::fclose(file);
+        return;
+    }
+    data_.resize(schema_.size());
+
+    std::uint64_t rowBytes = 0;
+    for (const auto& col : schema_)
+    {
+        rowBytes += col.width;
+    }
+    columnarChunkHeader chunk{};
+    while (std::fread(&chunk, sizeof(chunk), 1, file) == 1)
+    {
+        offset += sizeof(chunk);
+        if (offset > fileSize || (rowBytes > 0 && chunk.rowCount > (fileSize - offset) / rowBytes))
+        {
+            // A torn tail, or a corrupt row count: nothing after it can be trusted
+            break;
+        }
+        offset += chunk.rowCount * rowBytes;
+        bool complete = true;
+        for (std::size_t i = 0; i < schema_.size(); ++i)
+        {
+            auto& bytes = data_[i];
+            std::size_t offset = bytes.size();
+            bytes.resize(offset + chunk.rowCount * schema_[i].width);
+            if (std::fread(bytes.data() + offset, schema_[i].width, chunk.rowCount, file) != chunk.rowCount)
+            {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete)
+        {
+            // A writer that was interrupted mid-chunk leaves a torn tail, keep what is whole
+            for (std::size_t i = 0; i < schema_.size(); ++i)
+            {
+                data_[i].resize(rowCount_ * schema_[i].width);
+            }
+            break;
+        }
+        rowCount_ += chunk.rowCount;
+    }
+    std::fclose(file);
+    good_ = true;
+}
+
+int columnarReader::index(const std::string& name) const
+{
+    for (std::size_t i = 0; i < schema_.size(); ++i)
+    {
+        if (schema_[i].name == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::vector<double> columnarReader::f64(const std::string& name) const
+{
+    int i = index(name);
+    if (i < 0 || schema_[i].type != columnType::f64)
+    {
+        return {};
+    }
+    std::vector<double> values(rowCount_);
+    std::memcpy(values.data(), data_[i].data(), rowCount_ * sizeof(double));
+    return values;
+}
+
+std::vector<std::int64_t> columnarReader::i64(const std::string& name) const
+{
+    int i = index(name);
+    if (i < 0 || schema_[i].type != columnType::i64)
+    {
+        return {};
+    }
+    std::vector<std::int64_t> values(rowCount_);
+    std::memcpy(values.data(), data_[i].data(), rowCount_ * sizeof(std::int64_t));
+    return values;
+}
+
+std::vector<std::string> columnarReader::text(const std::string& name) const
+{
+    int i = index(name);
+    if (i < 0 || schema_[i].type != columnType::text)
+    {
+        return {};
+    }
+    std::vector<std::string> values;
+    values.reserve(rowCount_);
+    const std::uint32_t width = schema_[i].width;
+    for (std::uint64_t row = 0; row < rowCount_; ++row)
+    {
+        const char* value = data_[i].data() + row * width;
+        values.emplace_back(value, strnlen(value, width));
+    }
+    return values;
+}
+
+columnarStreamReader::columnarStreamReader(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    fileSize_ = std::filesystem::file_size(path, ec);
+    FILE* file = ec ? nullptr : std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return;
+    }
+
+    columnarFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)) != 0)
+    {
+        std::cerr << "Not a columnar file: " << path << std::endl;
+        std::fclose(file);
+        return;
+    }
+    for (std::uint32_t i = 0; i < header.columnCount; ++i)
+    {
+        columnarColumnDesc desc{};
+        if (std::fread(&desc, sizeof(desc), 1, file) != 1)
+        {
+            std::fclose(file);
+            schema_.clear();
+            return;
+        }
+        desc.name[COLUMNAR_NAME_SIZE - 1] = '\0';
+        schema_.push_back({desc.name, desc.type, desc.width});
+    }
+    std::uint64_t offset = sizeof(header) + header.columnCount * sizeof(columnarColumnDesc);
+    if (!readMetadata(file, header, fileSize_, offset, metadata_))
+    {
+        std::fclose(file);
+        schema_.clear();
+        return;
+    }
+    file_ = file;
+    chunkStart_ = offset;
+}
+
+columnarStreamReader::~columnarStreamReader()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+    }
+}
+
+int columnarStreamReader::column(const std::string& name) const
+{
+    for (std::size_t i = 0; i < schema_.size(); ++i)
+    {
+        if (schema_[i].name == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool columnarStreamReader::nextChunk()
+{
+    std::uint64_t rowBytes = 0;
+    for (const auto& col : schema_)
+    {
+        rowBytes += col.width;
+    }
+    // chunkStart_ still points at the finished chunk's data, the next header follows it
+    const std::uint64_t headerOffset = chunkStart_ + chunkRows_ * rowBytes;
+    columnarChunkHeader chunk{};
+    if (std::fseek(file_, static_cast<long>(headerOffset), SEEK_SET) != 0 || std::fread(&chunk, sizeof(chunk), 1, file_) != 1)
+    {
+        return false;
+    }
+    const std::uint64_t dataStart = headerOffset + sizeof(chunk);
+    if (rowBytes > 0 && chunk.rowCount > (fileSize_ - dataStart) / rowBytes)
+    {
+        // A writer that was interrupted mid-chunk leaves a torn tail
+        return false;
+    }
+    chunkStart_ = dataStart;
+    chunkRows_ = chunk.rowCount;
+    chunkPos_ = 0;
+    return true;
+}
+
+std::uint64_t columnarStreamReader::read(std::vector<std::vector<char>>& columns, std::uint64_t maxRows)
+{
+    columns.resize(schema_.size());
+    if (!file_ || maxRows == 0)
+    {
+        return 0;
+    }
+    while (chunkPos_ == chunkRows_)
+    {
+        if (!nextChunk())
+        {
+            return 0;
+        }
+    }
+
+    const std::uint64_t rows = std::min(maxRows, chunkRows_ - chunkPos_);
+    std::uint64_t columnOffset = chunkStart_;
+    for (std::size_t i = 0; i < schema_.size(); ++i)
+    {
+        const std::uint32_t width = schema_[i].width;
+        columns[i].resize(rows * width);
+        if (std::fseek(file_, static_cast<long>(columnOffset + chunkPos_ * width), SEEK_SET) != 0 ||
+            std::fread(columns[i].data(), width, rows, file_) != rows)
+        {
+            return 0;
+        }
+        columnOffset += chunkRows_ * width;
+    }
+    chunkPos_ += rows;
+    return rows;
+}
@@ -1,16 +1,88 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <functional>
 #include <queue>
 #include <string>
+#include "checkpoint.h"
 #include "components.h"
+#include "marketDataSource.h"
+#include "resultsStore.h"
+
+eventBus::eventBus(dispatchMode mode)
+{
+    if (mode == dispatchMode::scheduled)
+    {
+        scheduler_ = std::make_unique<eventScheduler>();
+        scheduler_->on(simEventType::bus, [this](const simEvent& queued) {
+            std::unique_ptr<event> evnt = std::move(queued_[queued.id]);
+            freeSlots_.push_back(queued.id);
+            dispatch(*evnt);
+        });
+    }
+}
 
 void eventBus::subscribe(const std::string& eventType, std::function<void(event&)> callback)
 {
     subscribers[eventType].push_back(callback);
 }
 
+void eventBus::subscribeFirst(const std::string& eventType, std::function<void(event&)> callback)
+{
+    auto& callbacks = subscribers[eventType];
+    callbacks.insert(callbacks.begin(), std::move(callback));
+}
+
 void eventBus::publish(event& evnt)
+{
+    if (!scheduler_)
+    {
+        dispatch(evnt);
+        return;
+    }
+
+    if (dispatching_)
+    {
+        // Published from inside a handler: runs after it instead of within it
+        std::unique_ptr<event> copy = evnt.clone();
+        if (copy)
+        {
+            simEvent queued;
+            queued.type = simEventType::bus;
+            if (freeSlots_.empty())
+            {
+                queued.id = queued_.size();
+                queued_.push_back(std::move(copy));
+            }
+            else
+            {
+                queued.id = freeSlots_.back();
+                freeSlots_.pop_back();
+                queued_[queued.id] = std::move(copy);
+            }
+            scheduler_->at(scheduler_->now(), queued);
+            return;
+        }
+        dispatch(evnt);
+        return;
+    }
+
+    // The top-level event needs no copy, it outlives the queue it starts
+    dispatching_ = true;
+    try
+    {
+        dispatch(evnt);
+        scheduler_->run(scheduler_->now());
+    }
+    catch (...)
+    {
+        dispatching_ = false;
+        throw;
+    }
+    dispatching_ = false;
+}
+
+void eventBus::dispatch(event& evnt)
 {
     const auto& eventType=evnt.type;
     if (subscribers.find(eventType) != subscribers.end())
@@ -28,11 +100,71 @@ void eventBus::publish(event& evnt)
 
 void dataHandler::simulateMarketData() 
 {
-    for (const auto& Data : historicalMarketData) 
+    arenaScope scope(arena);
+    std::size_t barsInBatch = 0;
+    // Starts at the cursor, so a restored checkpoint only replays the bars appended since
+    for (; currentDataIndex < historicalMarketData.size(); ++currentDataIndex) 
+    {
+        const MarketData& Data = historicalMarketData[currentDataIndex];
+        marketDataEvent* mDataEvent = arena.create<marketDataEvent>(Data.timestamp,Data);
+        bus.publish(*mDataEvent);
+
+        if (++barsInBatch == ARENA_BATCH_SIZE)
+        {
+            arena.reset();
+            barsInBatch = 0;
+        }
+    }
+    arena.reset();
+}
+
+void dataHandler::simulateMarketData(const marketDataView& view)
+{
+    arenaScope scope(arena);
+    MarketData Data;  // reused for every bar, events only refer to it while they are dispatched
+    std::size_t barsInBatch = 0;
+    // The cursor counts bars of the view, so a restored checkpoint resumes where it stopped
+    for (; currentDataIndex < view.size; ++currentDataIndex)
     {
-        marketDataEvent mDataEvent(Data.timestamp,Data);
-        bus.publish(mDataEvent);
+        view.fill(currentDataIndex, Data);
+        marketDataEvent* mDataEvent = arena.create<marketDataEvent>(Data.timestamp,Data);
+        bus.publish(*mDataEvent);
+
+        if (++barsInBatch == ARENA_BATCH_SIZE)
+        {
+            arena.reset();
+            barsInBatch = 0;
+        }
     }
+    arena.reset();
+}
+
+void dataHandler::simulateMarketData(marketDataSource& source, std::size_t chunkBars, std::size_t windowChunks)
+{
+    arenaScope scope(arena);
+    chunkReadAhead chunks(source, chunkBars, windowChunks);
+    std::size_t barsInBatch = 0;
+    std::size_t chunkStart = 0;   // position of the chunk's first bar in the source
+    // Events refer to bars in the current chunk, which stays alive until the next one is taken
+    while (const std::vector<MarketData>* chunk = chunks.next())
+    {
+        // Bars before the cursor were replayed before a checkpoint, the source is read past them
+        std::size_t first = currentDataIndex > chunkStart ? std::min(currentDataIndex - chunkStart, chunk->size()) : 0;
+        chunkStart += chunk->size();
+        for (std::size_t i = first; i < chunk->size(); ++i, ++currentDataIndex)
+        {
+            const MarketData& Data = (*chunk)[i];
+            marketDataEvent* mDataEvent = arena.create<marketDataEvent>(Data.timestamp,Data);
+            bus.publish(*mDataEvent);
+
+            if (++barsInBatch == ARENA_BATCH_SIZE)
+            {
+                arena.reset();
+                barsInBatch = 0;
+            }
+        }
+    }
+    arena.reset();
 }
 
 MarketData dataHandler::getNextMarketData()
@@ -62,70 +194,98 @@ void dataHandler::simulateNextMarketDataEvent()
     bus.publish(mDataEvent);
 }
 
-MarketData strategyEngine::extractMarketData(const marketDataEvent& evnt)
+const MarketData& strategyEngine::extractMarketData(const marketDataEvent& evnt)
 {
-    // Extract relevant fields from the event
-    MarketData marketData(
-        evnt.data_.timestamp,
-        evnt.data_.open,
-        evnt.data_.high,
-        evnt.data_.low,
-        evnt.data_.close,
-        evnt.data_.volume
-    );
-
-    return marketData;
+    // The event refers to the bar held by the data source, no copy needed
+    return evnt.data_;
 }
 
 void strategyEngine::onMarketData(const marketDataEvent& evnt) 
 {
     std::cout << "Received MarketData event" << std::endl;
     const MarketData& marketData = strategyEngine::extractMarketData(evnt);
-    std::unordered_map<std::string,double> signal = strategyEngine::generateSignal(marketData);
 
-    std::string ts=marketData.timestamp;
-    signalEvent sigEvent{ts, {{"type",0}}};
+    signalEvent sigEvent{marketData.timestamp, tradeSignal{0, 0, marketData.close}};
 
     bus.publish(sigEvent);
 }
 
-std::unordered_map<std::string,double> strategyEngine::generateSignal(const MarketData& marketData)
+signalMap strategyEngine::generateSignal(const MarketData& marketData)
+{
+    return {{"type",0}, {"closePrice",marketData.close}};
+}
+
+void strategyEngine::saveState(checkpointWriter& out) const
 {
-    return {{"type",0}};
+    // The random stream position, so a resumed run draws what an uninterrupted one would
+    out.put(rng);
+}
+
+bool strategyEngine::loadState(checkpointReader& in)
+{
+    return in.get(rng);
 }
 
 void broker::onSignal(const signalEvent& evnt) 
 {
 
     // Check the signal and execute the corresponding order
-    if (evnt.data_.at("type") == 1.0 && !inPosition) 
+    if (evnt.signal_.type == 1 && !book_.inPosition) 
     {
         executeBuyOrder(evnt);
     } 
-    else if (evnt.data_.at("type") == 2.0 && inPosition) 
+    else if (evnt.signal_.type == 2 && book_.inPosition) 
     {
         executeSellOrder(evnt);
     }
+
+    // Mark to market once per bar; every signal carries the bar's close, holds included,
+    // only a plugin map without a closePrice key is skipped
+    if (results_ && evnt.signal_.closePrice > 0)
+    {
+        results_->recordEquity(evnt.timestamp, book_.cash + book_.asset*evnt.signal_.closePrice);
+    }
 }
 
 //void broker::executeBuyOrder(const MarketData& marketData) 
 void broker::executeBuyOrder(const signalEvent& evnt)
 {
-    cash -= cash*evnt.data_.at("fraction");
-    inPosition = true;
+    const tradeSignal& sig = evnt.signal_;
+    if (sig.closePrice <= 0)
+    {
+        std::cout << evnt.timestamp<<" | "<< "BUY signal without a price, ignored" << std::endl;
+        return;
+    }
+    book_.buy(sig.fraction, sig.closePrice);
+
+    if (results_)
+    {
+        results_->recordFill(evnt.timestamp, 1, sig.fraction, sig.closePrice, book_.cash);
+        results_->recordPosition(evnt.timestamp, book_.asset, book_.cash, book_.inPosition);
+    }
 
-    std::cout << evnt.timestamp<<" | "<< "Executed BUY order | Cash: "<< cash << std::endl;
+    std::cout << evnt.timestamp<<" | "<< "Executed BUY order | Cash: "<< book_.cash << std::endl;
     std::cout<<std::endl;
 }
 
 void broker::executeSellOrder(const signalEvent& evnt) 
 {
-    if(inPosition==true)
+    const tradeSignal& sig = evnt.signal_;
+    if (sig.closePrice <= 0)
+    {
+        std::cout << evnt.timestamp<<" | "<< "SELL signal without a price, ignored" << std::endl;
+        return;
+    }
+    if(book_.inPosition==true)
     {
-        cash += asset*evnt.data_.at("fraction")*evnt.data_.at("closePrice");
-        asset=asset-asset*evnt.data_.at("fraction");
-        inPosition = false;
+        book_.sell(sig.fraction, sig.closePrice);
+
+        if (results_)
+        {
+            results_->recordFill(evnt.timestamp, 2, sig.fraction, sig.closePrice, book_.cash);
+            results_->recordPosition(evnt.timestamp, book_.asset, book_.cash, book_.inPosition);
+        }
     }
-    std::cout << evnt.timestamp<<" | "<< "Executed SELL order | Cash: "<< cash << std::endl;
+    std::cout << evnt.timestamp<<" | "<< "Executed SELL order | Cash: "<< book_.cash << std::endl;
     std::cout<<std::endl;
 }
\ No newline at end of file
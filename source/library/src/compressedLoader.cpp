@@ -0,0 +1,439 @@
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include "compressedLoader.h"
+#include "localTimeFormatter.h"
+
+#ifdef QENG_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef QENG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+constexpr std::size_t INPUT_CHUNK = 1 << 20;
+
+// Parses the number at the start of [begin, end). Returns where it stopped, nullptr when
+// there is no number. Floating-point from_chars is locale-free and needs no terminator,
+// but older standard libraries (libc++ before LLVM 17, so Apple's toolchains up to at least
+// Xcode 15) lack it; there each field is copied into a terminated buffer for strtod.
+const char* parseNumber(const char* begin, const char* end, double& value)
+{
+#if defined(__cpp_lib_to_chars)
+    auto [next, error] = std::from_chars(begin, end, value);
+    return error == std::errc() ? next : nullptr;
+#else
+    const char* fieldEnd = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+    fieldEnd = fieldEnd ? fieldEnd : end;
+    char buffer[64];
+    const std::size_t length = static_cast<std::size_t>(fieldEnd - begin);
+    if (length == 0 || length >= sizeof(buffer))
+    {
+        return nullptr;
+    }
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    char* next = nullptr;
+    value = std::strtod(buffer, &next);
+    return next == buffer ? nullptr : begin + (next - buffer);
+#endif
+}
+
+// Fills BLOCK_SIZE output blocks and pushes them downstream as they fill up
+class blockSink
+{
+public:
+    explicit blockSink(boundedQueue<std::string>& out) : out_(out) { block_.resize(csvBlockReader::BLOCK_SIZE); }
+
+    char* space() { return block_.data() + used_; }
+    std::size_t spaceLeft() const { return block_.size() - used_; }
+
+    // Returns false once the consumer side is gone
+    bool commit(std::size_t bytes)
+    {
+        used_ += bytes;
+        total_ += bytes;
+        return used_ < block_.size() || push();
+    }
+
+    bool finish() { return used_ == 0 || push(); }
+    std::size_t total() const { return total_; }
+
+private:
+    bool push()
+    {
+        block_.resize(used_);
+        bool pushed = out_.push(std::move(block_));
+        block_ = std::string(csvBlockReader::BLOCK_SIZE, '\0');
+        used_ = 0;
+        return pushed;
+    }
+
+    boundedQueue<std::string>& out_;
+    std::string block_;
+    std::size_t used_ = 0;
+    std::size_t total_ = 0;
+};
+
+bool readPlain(std::istream& file, blockSink& sink)
+{
+    while (file)
+    {
+        file.read(sink.space(), static_cast<std::streamsize>(sink.spaceLeft()));
+        if (file.gcount() > 0 && !sink.commit(static_cast<std::size_t>(file.gcount())))
+        {
+            return false;
+        }
+    }
+    return sink.finish();
+}
+
+#ifdef QENG_HAVE_ZLIB
+bool inflateGzip(std::istream& file, blockSink& sink)
+{
+    z_stream stream{};
+    // 15 + 32: largest window, detect the gzip/zlib header automatically
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        std::cerr << "Error initialising zlib" << std::endl;
+        return false;
+    }
+
+    std::vector<char> input(INPUT_CHUNK);
+    bool ok = true;
+    int status = Z_OK;
+    while (ok)
+    {
+        if (stream.avail_in == 0)
+        {
+            file.read(input.data(), static_cast<std::streamsize>(input.size()));
+            if (file.gcount() == 0)
+            {
+                break;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(file.gcount());
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(sink.space());
+        stream.avail_out = static_cast<uInt>(sink.spaceLeft());
+        const std::size_t before = sink.spaceLeft();
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+        {
+            std::cerr << "Error decompressing gzip data: " << (stream.msg ? stream.msg : "corrupt input") << std::endl;
+            ok = false;
+            break;
+        }
+        ok = sink.commit(before - stream.avail_out);
+        if (status == Z_STREAM_END)
+        {
+            // Concatenated gzip members (e.g. from parallel gzip) are one logical file
+            inflateReset(&stream);
+        }
+    }
+    if (ok && status != Z_STREAM_END)
+    {
+        std::cerr << "Truncated gzip data" << std::endl;
+        ok = false;
+    }
+    inflateEnd(&stream);
+    return sink.finish() && ok;
+}
+#endif
+
+#ifdef QENG_HAVE_ZSTD
+bool decompressZstd(std::istream& file, blockSink& sink)
+{
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream || ZSTD_isError(ZSTD_initDStream(stream)))
+    {
+        std::cerr << "Error initialising zstd" << std::endl;
+        ZSTD_freeDStream(stream);
+        return false;
+    }
+
+    std::vector<char> input(INPUT_CHUNK);
+    ZSTD_inBuffer in{input.data(), 0, 0};
+    bool ok = true;
+    std::size_t remaining = 0;   // 0 once a frame is complete
+    while (ok)
+    {
+        if (in.pos == in.size)
+        {
+            file.read(input.data(), static_cast<std::streamsize>(input.size()));
+            if (file.gcount() == 0)
+            {
+                break;
+            }
+            in.size = static_cast<std::size_t>(file.gcount());
+            in.pos = 0;
+        }
+
+        ZSTD_outBuffer out{sink.space(), sink.spaceLeft(), 0};
+        remaining = ZSTD_decompressStream(stream, &out, &in);
+        if (ZSTD_isError(remaining))
+        {
+            std::cerr << "Error decompressing zstd data: " << ZSTD_getErrorName(remaining) << std::endl;
+            ok = false;
+            break;
+        }
+        ok = sink.commit(out.pos);
+    }
+    if (ok && remaining != 0)
+    {
+        std::cerr << "Truncated zstd data" << std::endl;
+        ok = false;
+    }
+    ZSTD_freeDStream(stream);
+    return sink.finish() && ok;
+}
+#endif
+}
+
+csvBlockReader::csvBlockReader(const std::filesystem::path& path, std::size_t queueBlocks)
+    : path_(path), file_(path, std::ios::binary), blocks_(queueBlocks)
+{
+    if (!file_.is_open())
+    {
+        std::cerr << "Error opening file: " << path_ << std::endl;
+        blocks_.close();
+        return;
+    }
+    thread_ = std::thread([this, type = detect(file_)] {
+        decompress(type);
+        blocks_.close();
+    });
+}
+
+csvBlockReader::~csvBlockReader()
+{
+    // Unblocks the reader thread if the consumer stopped early
+    blocks_.close();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool csvBlockReader::nextBlock(std::string& block)
+{
+    return blocks_.pop(block);
+}
+
+csvBlockReader::compression csvBlockReader::detect(std::istream& file)
+{
+    unsigned char magic[4] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    file.clear();
+    file.seekg(0);
+
+    if (magic[0] == 0x1f && magic[1] == 0x8b)
+    {
+        return compression::gzip;
+    }
+    if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+    {
+        return compression::zstd;
+    }
+    return compression::none;
+}
+
+void csvBlockReader::decompress(compression type)
+{
+    blockSink sink(blocks_);
+    bool ok = false;
+    switch (type)
+    {
+    case compression::none:
+        ok = readPlain(file_, sink);
+        break;
+    case compression::gzip:
+#ifdef QENG_HAVE_ZLIB
+        ok = inflateGzip(file_, sink);
+#else
+        std::cerr << "Built without zlib, cannot read " << path_ << std::endl;
+#endif
+        break;
+    case compression::zstd:
+#ifdef QENG_HAVE_ZSTD
+        ok = decompressZstd(file_, sink);
+#else
+        std::cerr << "Built without zstd, cannot read " << path_ << std::endl;
+#endif
+        break;
+    }
+    bytesDecompressed_ = sink.total();
+    good_ = ok;
+}
+
+bool parseMarketDataLine(const char* begin, const char* end, MarketData& bar)
+{
+    thread_local localTimeFormatter formatter;
+
+    // misc,timestamp(ms),open,high,low,close,volume
+    const char* field = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+    double timestamp = 0;
+    double* values[] = {&timestamp, &bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+    for (double* value : values)
+    {
+        if (!field)
+        {
+            return false;
+        }
+        const char* next = parseNumber(field + 1, end, *value);
+        if (!next || (next != end && *next != ',' && *next != '\r'))
+        {
+            return false;
+        }
+        field = next;
+    }
+    formatter.format(static_cast<long long>(timestamp), bar.timestamp);
+    return true;
+}
+
+void compressedDataLoader::splitLines(csvBlockReader& in, boundedQueue<lineBlock>& out)
+{
+    std::string pending;
+    std::string raw;
+    std::size_t index = 0;
+    bool headerSkipped = false;
+
+    while (in.nextBlock(raw))
+    {
+        if (pending.empty())
+        {
+            pending = std::move(raw);
+        }
+        else
+        {
+            pending.append(raw);
+        }
+
+        if (!headerSkipped)
+        {
+            const std::size_t headerEnd = pending.find('\n');
+            if (headerEnd == std::string::npos)
+            {
+                continue;
+            }
+            pending.erase(0, headerEnd + 1);
+            headerSkipped = true;
+        }
+
+        // Hand over everything up to the last line end, keep the partial line for the next block
+        const std::size_t lastLine = pending.rfind('\n');
+        if (lastLine == std::string::npos)
+        {
+            continue;
+        }
+        std::string rest(pending, lastLine + 1);
+        pending.resize(lastLine + 1);
+        if (!out.push({index++, std::move(pending)}))
+        {
+            return;
+        }
+        pending = std::move(rest);
+    }
+
+    // Last line without a trailing newline
+    if (headerSkipped && !pending.empty())
+    {
+        pending.push_back('\n');
+        out.push({index, std::move(pending)});
+    }
+}
+
+std::size_t compressedDataLoader::parseBlock(const std::string& text, std::vector<MarketData>& rows)
+{
+    std::size_t malformed = 0;
+    MarketData data;
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line = p;
+        p = lineEnd + 1;
+        if (lineEnd == line || (lineEnd == line + 1 && *line == '\r'))
+        {
+            continue;
+        }
+        if (!parseMarketDataLine(line, lineEnd, data))
+        {
+            ++malformed;
+            continue;
+        }
+        rows.push_back(std::move(data));
+    }
+    return malformed;
+}
+
+void compressedDataLoader::loadData()
+{
+    csvBlockReader rawBlocks(filePath, QUEUE_BLOCKS);
+    boundedQueue<lineBlock> lineBlocks(QUEUE_BLOCKS + numParsers);
+
+    // Blocks finish out of order; each parser files its rows under the block index
+    std::vector<std::vector<MarketData>> parsed;
+    std::mutex parsedMutex;
+    std::size_t malformed = 0;
+
+    std::thread splitter([&] {
+        splitLines(rawBlocks, lineBlocks);
+        lineBlocks.close();
+    });
+    std::vector<std::thread> parsers;
+    for (std::size_t i = 0; i < numParsers; ++i)
+    {
+        parsers.emplace_back([&] {
+            lineBlock block;
+            while (lineBlocks.pop(block))
+            {
+                std::vector<MarketData> rows;
+                rows.reserve(block.text.size() / 64);
+                std::size_t bad = parseBlock(block.text, rows);
+
+                std::lock_guard<std::mutex> lock(parsedMutex);
+                if (parsed.size() <= block.index)
+                {
+                    parsed.resize(block.index + 1);
+                }
+                parsed[block.index] = std::move(rows);
+                malformed += bad;
+            }
+        });
+    }
+
+    splitter.join();
+    for (auto& parser : parsers)
+    {
+        parser.join();
+    }
+
+    std::size_t total = 0;
+    for (const auto& rows : parsed)
+    {
+        total += rows.size();
+    }
+    data_.reserve(total);
+    for (auto& rows : parsed)
+    {
+        std::move(rows.begin(), rows.end(), std::back_inserter(data_));
+    }
+    malformedLines_ = malformed;
+    if (malformed > 0)
+    {
+        std::cerr << "Skipped " << malformed << " malformed lines in " << filePath << std::endl;
+    }
+    bytesDecompressed_ = rawBlocks.bytesDecompressed();
+    good_ = rawBlocks.good();
+}
@@ -0,0 +1,206 @@
+#include <cstdio>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include "columnar.h"
+#include "featureCache.h"
+
+std::string featureKey::canonical() const
+{
+    std::ostringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << dataset << std::dec << '|' << indicator << '|';
+    ss << std::setprecision(17);
+    for (std::size_t i = 0; i < params.size(); ++i)
+    {
+        ss << (i ? "," : "") << params[i];
+    }
+    ss << '|' << timeframe;
+    return ss.str();
+}
+
+featureCache::featureCache(std::size_t memoryBudgetBytes, std::filesystem::path diskDirectory)
+    : memoryBudget_(memoryBudgetBytes), diskDirectory_(std::move(diskDirectory))
+{
+    if (!diskDirectory_.empty())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(diskDirectory_, ec);
+        if (ec)
+        {
+            std::cerr << "Error creating feature cache directory: " << diskDirectory_ << std::endl;
+            diskDirectory_.clear();
+        }
+    }
+}
+
+featureCache::series featureCache::get(const featureKey& key, const std::function<std::vector<double>()>& compute)
+{
+    const std::string id = key.canonical();
+    std::promise<series> promise;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = entries_.find(id);
+        if (it != entries_.end())
+        {
+            ++stats_.memoryHits;
+            if (it->second.resident)
+            {
+                lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+                return it->second.ready.get();
+            }
+            // Another thread is producing it right now
+            std::shared_future<series> pending = it->second.ready;
+            lock.unlock();
+            return pending.get();
+        }
+        entry fresh;
+        fresh.ready = promise.get_future().share();
+        entries_.emplace(id, std::move(fresh));
+    }
+
+    // Load or compute outside the lock so other keys are not held up
+    series value;
+    bool fromDisk = false;
+    try
+    {
+        const std::filesystem::path path = diskDirectory_.empty() ? std::filesystem::path() : pathFor(id);
+        if (!path.empty())
+        {
+            try
+            {
+                value = loadFromDisk(path, id);
+            }
+            catch (const std::exception& e)
+            {
+                // An unreadable cache file is a miss, the series is recomputed and rewritten
+                std::cerr << "Ignoring feature cache file " << path << ": " << e.what() << std::endl;
+                value = nullptr;
+            }
+            fromDisk = value != nullptr;
+        }
+        if (!value)
+        {
+            value = std::make_shared<const std::vector<double>>(compute());
+            if (!path.empty())
+            {
+                saveToDisk(path, id, *value);
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.erase(id);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry& e = entries_[id];
+        e.bytes = value->size() * sizeof(double);
+        e.resident = true;
+        lru_.push_front(id);
+        e.lruPos = lru_.begin();
+        stats_.bytesInMemory += e.bytes;
+        ++(fromDisk ? stats_.diskHits : stats_.computed);
+        evictLocked();
+    }
+    promise.set_value(value);
+    return value;
+}
+
+void featureCache::setMemoryBudget(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    memoryBudget_ = bytes;
+    evictLocked();
+}
+
+featureCache::statistics featureCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void featureCache::evictLocked()
+{
+    // The most recent series always stays, even if it alone exceeds the budget
+    while (stats_.bytesInMemory > memoryBudget_ && lru_.size() > 1)
+    {
+        auto it = entries_.find(lru_.back());
+        stats_.bytesInMemory -= it->second.bytes;
+        entries_.erase(it);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+std::filesystem::path featureCache::pathFor(const std::string& canonicalKey) const
+{
+    // FNV-1a of the canonical key names the file
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : canonicalKey)
+    {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << h << ".qcol";
+    return diskDirectory_ / name.str();
+}
+
+// A cache file holds the series as an f64 column, one row per value, with the canonical key
+// as the file's metadata. The key is compared on load, so a hash collision or a file left by
+// another key is recomputed instead of being served as the wrong series.
+featureCache::series featureCache::loadFromDisk(const std::filesystem::path& path, const std::string& canonicalKey) const
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec))
+    {
+        return nullptr;
+    }
+    columnarReader in(path);
+    if (!in.good() || in.metadata() != canonicalKey || in.rowCount() == 0)
+    {
+        return nullptr;
+    }
+    std::vector<double> values = in.f64("value");
+    if (values.size() != in.rowCount())
+    {
+        return nullptr;
+    }
+    return std::make_shared<const std::vector<double>>(std::move(values));
+}
+
+void featureCache::saveToDisk(const std::filesystem::path& path, const std::string& canonicalKey, const std::vector<double>& values) const
+{
+    // Empty series are cheaper to recompute than to store
+    if (values.empty())
+    {
+        return;
+    }
+
+    // Write next to the target and rename, so concurrent runs never see a partial file
+    std::filesystem::path tmp = path;
+    tmp += "." + std::to_string(::getpid()) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        columnarWriter out(tmp, {columnSpec::f64("value")}, canonicalKey);
+        if (!out.good() || !out.appendChunk({values.data()}, values.size()))
+        {
+            std::cerr << "Error writing feature cache file: " << tmp << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+    }
+}
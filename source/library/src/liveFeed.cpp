@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "liveFeed.h"
+
+long long latencyRecorder::percentile(double p) const
+{
+    if (samples_.empty())
+    {
+        return 0;
+    }
+    std::vector<long long> sorted(samples_);
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    rank = std::min(rank, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+void latencyRecorder::report(std::ostream& out) const
+{
+    out << "Tick-to-signal latency over " << count() << " bars (us)"
+        << " | p50: " << percentile(50) / 1000.0
+        << " | p90: " << percentile(90) / 1000.0
+        << " | p99: " << percentile(99) / 1000.0
+        << " | p99.9: " << percentile(99.9) / 1000.0
+        << " | max: " << percentile(100) / 1000.0 << std::endl;
+}
+
+liveFeed::liveFeed(int fd) : fd_(fd), ring_(std::make_unique<spscRingBuffer<liveBar, RING_CAPACITY>>()) {}
+
+liveFeed::~liveFeed()
+{
+    stop();
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+int liveFeed::openPipe(const std::filesystem::path& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error opening feed: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+    }
+    return fd;
+}
+
+int liveFeed::connectSocket(const std::filesystem::path& path)
+{
+    sockaddr_un addr{};
+    if (path.native().size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Error creating socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << "Error connecting to feed: " << path << " (" << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void liveFeed::start()
+{
+    if (fd_ < 0)
+    {
+        std::cerr << "Live feed has no open source" << std::endl;
+        eof_.store(true, std::memory_order_release);
+        return;
+    }
+    running_.store(true, std::memory_order_release);
+    feedThread_ = std::thread(&liveFeed::readLoop, this);
+}
+
+void liveFeed::stop()
+{
+    running_.store(false, std::memory_order_release);
+    if (feedThread_.joinable())
+    {
+        feedThread_.join();
+    }
+}
+
+void liveFeed::readLoop()
+{
+    constexpr std::size_t BUFFER_SIZE = 1 << 16;
+    std::vector<char> buffer(BUFFER_SIZE);
+    std::size_t filled = 0;
+
+    while (running_.load(std::memory_order_acquire))
+    {
+        // Wake up periodically so a stop request is noticed even when the source is silent
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 100);
+        if (ready == 0 || (ready < 0 && errno == EINTR))
+        {
+            continue;
+        }
+
+        ssize_t n = ::read(fd_, buffer.data() + filled, buffer.size() - filled);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        filled += static_cast<std::size_t>(n);
+
+        // Hand over every complete line, keep the partial tail for the next read
+        const char* lineStart = buffer.data();
+        const char* end = buffer.data() + filled;
+        while (const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart)))
+        {
+            liveBar bar;
+            if (parseLine(lineStart, newline, bar))
+            {
+                bar.received = std::chrono::steady_clock::now();
+                while (!ring_->tryPush(bar))
+                {
+                    // Consumer is behind, apply backpressure rather than dropping bars
+                    if (!running_.load(std::memory_order_acquire))
+                    {
+                        return;
+                    }
+                    cpuRelax();
+                }
+                barsReceived_.fetch_add(1, std::memory_order_relaxed);
+            }
+            lineStart = newline + 1;
+        }
+
+        filled = end - lineStart;
+        std::memmove(buffer.data(), lineStart, filled);
+        if (filled == buffer.size())
+        {
+            std::cerr << "Feed line longer than " << BUFFER_SIZE << " bytes, discarding" << std::endl;
+            filled = 0;
+        }
+    }
+
+    // A last line without a trailing newline is still a bar
+    liveBar bar;
+    if (filled > 0)
+    {
+        buffer[filled] = '\n';  // terminate it so the number parsing cannot run into stale bytes
+    }
+    if (filled > 0 && parseLine(buffer.data(), buffer.data() + filled, bar))
+    {
+        bar.received = std::chrono::steady_clock::now();
+        while (!ring_->tryPush(bar) && running_.load(std::memory_order_acquire))
+        {
+            cpuRelax();
+        }
+        barsReceived_.fetch_add(1, std::memory_order_relaxed);
+    }
+    eof_.store(true, std::memory_order_release);
+}
+
+bool liveFeed::parseLine(const char* begin, const char* end, liveBar& bar)
+{
+    // Skip the first (misc) column
+    const char* p = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+    if (!p)
+    {
+        return false;
+    }
+    ++p;
+
+    // Fields are separated by ',' and the line ends at '\n', so strtod stops on its own
+    char* next = nullptr;
+    bar.timestampMs = static_cast<long long>(std::strtod(p, &next));
+    if (next == p || next >= end || *next != ',')
+    {
+        // Header or malformed line
+        return false;
+    }
+
+    double* fields[] = {&bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+    for (double* field : fields)
+    {
+        p = next + 1;
+        *field = std::strtod(p, &next);
+        if (next == p || next > end)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+liveDataHandler::liveDataHandler(eventBus& Bus, liveFeed& feed, waitPolicy policy)
+    : bus(Bus), feed_(feed), policy_(policy)
+{
+    // Ahead of the broker, so the sample is taken when the signal is published rather than
+    // after the order it triggers has been executed
+    bus.subscribeFirst("Signal", [this](event&) { this->onSignal(); });
+}
+
+void liveDataHandler::onSignal()
+{
+    // Only the first signal for a bar counts towards tick-to-signal latency
+    if (awaitingSignal_)
+    {
+        latency_.record(std::chrono::steady_clock::now() - currentReceived_);
+        awaitingSignal_ = false;
+    }
+}
+
+void liveDataHandler::run()
+{
+    arenaScope scope(arena_);
+    backoff waiter(policy_);
+    liveBar bar;
+    MarketData data;
+
+    while (!stopRequested_.load(std::memory_order_acquire))
+    {
+        if (!feed_.poll(bar))
+        {
+            if (feed_.finished())
+            {
+                break;
+            }
+            waiter.pause();
+            continue;
+        }
+        waiter.reset();
+
+        formatter_.format(bar.timestampMs, data.timestamp);
+        data.open = bar.open;
+        data.high = bar.high;
+        data.low = bar.low;
+        data.close = bar.close;
+        data.volume = bar.volume;
+
+        currentReceived_ = bar.received;
+        awaitingSignal_ = true;
+
+        {
+            marketDataEvent mDataEvent{data.timestamp, data};
+            bus.publish(mDataEvent);
+        }
+        arena_.reset();
+    }
+}
@@ -0,0 +1,81 @@
+#include "columnar.h"
+#include "marketDataCache.h"
+
+bool writeMarketDataCache(const std::filesystem::path& path, const std::vector<MarketData>& bars)
+{
+    const std::size_t n = bars.size();
+    std::vector<char> timestamps(n * MARKET_DATA_TIMESTAMP_WIDTH, '\0');
+    std::vector<double> open(n), high(n), low(n), close(n), volume(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const std::string& ts = bars[i].timestamp;
+        std::copy_n(ts.data(), std::min<std::size_t>(ts.size(), MARKET_DATA_TIMESTAMP_WIDTH), timestamps.data() + i * MARKET_DATA_TIMESTAMP_WIDTH);
+        open[i] = bars[i].open;
+        high[i] = bars[i].high;
+        low[i] = bars[i].low;
+        close[i] = bars[i].close;
+        volume[i] = bars[i].volume;
+    }
+
+    columnarWriter out(path, {columnSpec::text("timestamp", MARKET_DATA_TIMESTAMP_WIDTH), columnSpec::f64("open"), columnSpec::f64("high"),
+                              columnSpec::f64("low"), columnSpec::f64("close"), columnSpec::f64("volume")});
+    return out.good() && out.appendChunk({timestamps.data(), open.data(), high.data(), low.data(), close.data(), volume.data()}, n);
+}
+
+bool isMarketDataCache(const columnarReader& in)
+{
+    if (!in.good())
+    {
+        return false;
+    }
+    const std::vector<columnSpec>& schema = in.schema();
+    auto find = [&schema](const char* name) -> const columnSpec* {
+        for (const auto& col : schema)
+        {
+            if (col.name == name)
+            {
+                return &col;
+            }
+        }
+        return nullptr;
+    };
+
+    const columnSpec* timestamp = find("timestamp");
+    if (!timestamp || timestamp->type != columnType::text || timestamp->width != MARKET_DATA_TIMESTAMP_WIDTH)
+    {
+        return false;
+    }
+    for (const char* name : {"open", "high", "low", "close", "volume"})
+    {
+        const columnSpec* col = find(name);
+        if (!col || col->type != columnType::f64 || col->width != sizeof(double))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<MarketData> readMarketDataCache(const std::filesystem::path& path)
+{
+    columnarReader in(path);
+    if (!in.good())
+    {
+        return {};
+    }
+    if (!isMarketDataCache(in))
+    {
+        std::cerr << "Not a market data cache: " << path << std::endl;
+        return {};
+    }
+    std::vector<std::string> timestamps = in.text("timestamp");
+    std::vector<double> open = in.f64("open"), high = in.f64("high"), low = in.f64("low"), close = in.f64("close"), volume = in.f64("volume");
+
+    std::vector<MarketData> bars;
+    bars.reserve(in.rowCount());
+    for (std::size_t i = 0; i < in.rowCount(); ++i)
+    {
+        bars.emplace_back(std::move(timestamps[i]), open[i], high[i], low[i], close[i], volume[i]);
+    }
+    return bars;
+}
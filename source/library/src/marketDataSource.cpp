@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "marketDataSource.h"
+
+bool csvMarketDataSource::nextLine(const char*& begin, const char*& end)
+{
+    while (!finished_)
+    {
+        const char* data = block_.data();
+        const char* newline = static_cast<const char*>(std::memchr(data + pos_, '\n', block_.size() - pos_));
+        if (newline)
+        {
+            const std::size_t start = pos_;
+            pos_ = newline - data + 1;
+            if (partial_.empty())
+            {
+                begin = data + start;
+                end = newline;
+            }
+            else
+            {
+                partial_.append(data + start, newline);
+                begin = partial_.data();
+                end = begin + partial_.size();
+            }
+            return true;
+        }
+
+        // Keep the unfinished line and move on to the next block
+        partial_.append(data + pos_, block_.size() - pos_);
+        pos_ = 0;
+        if (!reader_.nextBlock(block_))
+        {
+            block_.clear();
+            finished_ = true;
+        }
+    }
+
+    // Last line without a trailing newline
+    if (partial_.empty())
+    {
+        return false;
+    }
+    block_.swap(partial_);
+    partial_.clear();
+    begin = block_.data();
+    end = begin + block_.size();
+    return true;
+}
+
+bool csvMarketDataSource::nextChunk(std::vector<MarketData>& chunk, std::size_t maxBars)
+{
+    std::size_t count = 0;
+    const char* begin;
+    const char* end;
+    while (count < maxBars && nextLine(begin, end))
+    {
+        // A line taken from partial_ stays valid until the next call; release it afterwards
+        const bool fromPartial = !partial_.empty() && begin == partial_.data();
+
+        if (!headerSkipped_)
+        {
+            headerSkipped_ = true;
+        }
+        else if (end > begin && !(end == begin + 1 && *begin == '\r'))
+        {
+            if (count == chunk.size())
+            {
+                chunk.emplace_back();
+            }
+            if (parseMarketDataLine(begin, end, chunk[count]))
+            {
+                ++count;
+            }
+            else
+            {
+                ++malformedLines_;
+            }
+        }
+
+        if (fromPartial)
+        {
+            partial_.clear();
+        }
+    }
+    chunk.resize(count);
+    return count > 0;
+}
+
+cacheMarketDataSource::cacheMarketDataSource(const std::filesystem::path& path) : reader_(path)
+{
+    timestamp_ = reader_.column("timestamp");
+    open_ = reader_.column("open");
+    high_ = reader_.column("high");
+    low_ = reader_.column("low");
+    close_ = reader_.column("close");
+    volume_ = reader_.column("volume");
+
+    good_ = reader_.good() && std::min({timestamp_, open_, high_, low_, close_, volume_}) >= 0;
+    for (int col : {open_, high_, low_, close_, volume_})
+    {
+        good_ = good_ && reader_.schema()[col].type == columnType::f64;
+    }
+    good_ = good_ && reader_.schema()[timestamp_].type == columnType::text;
+    if (reader_.good() && !good_)
+    {
+        std::cerr << "Not a market data cache: " << path << std::endl;
+    }
+}
+
+bool cacheMarketDataSource::nextChunk(std::vector<MarketData>& chunk, std::size_t maxBars)
+{
+    if (!good_)
+    {
+        chunk.clear();
+        return false;
+    }
+    const std::uint64_t rows = reader_.read(columns_, maxBars);
+    chunk.resize(rows);
+
+    const std::uint32_t width = reader_.schema()[timestamp_].width;
+    for (std::uint64_t i = 0; i < rows; ++i)
+    {
+        const char* ts = columns_[timestamp_].data() + i * width;
+        chunk[i].timestamp.assign(ts, strnlen(ts, width));
+        std::memcpy(&chunk[i].open, columns_[open_].data() + i * sizeof(double), sizeof(double));
+        std::memcpy(&chunk[i].high, columns_[high_].data() + i * sizeof(double), sizeof(double));
+        std::memcpy(&chunk[i].low, columns_[low_].data() + i * sizeof(double), sizeof(double));
+        std::memcpy(&chunk[i].close, columns_[close_].data() + i * sizeof(double), sizeof(double));
+        std::memcpy(&chunk[i].volume, columns_[volume_].data() + i * sizeof(double), sizeof(double));
+    }
+    return rows > 0;
+}
+
+chunkReadAhead::chunkReadAhead(marketDataSource& source, std::size_t chunkBars, std::size_t window)
+    : source_(source), chunkBars_(std::max<std::size_t>(1, chunkBars)),
+      free_(std::max<std::size_t>(2, window)), loaded_(std::max<std::size_t>(2, window))
+{
+    // One buffer being replayed, the others loading or loaded
+    for (std::size_t i = 0; i < std::max<std::size_t>(2, window); ++i)
+    {
+        free_.push({});
+    }
+    loader_ = std::thread(&chunkReadAhead::loadLoop, this);
+}
+
+chunkReadAhead::~chunkReadAhead()
+{
+    free_.close();
+    loaded_.close();
+    loader_.join();
+}
+
+void chunkReadAhead::loadLoop()
+{
+    std::vector<MarketData> chunk;
+    while (free_.pop(chunk))
+    {
+        if (!source_.nextChunk(chunk, chunkBars_) || !loaded_.push(std::move(chunk)))
+        {
+            break;
+        }
+    }
+    loaded_.close();
+}
+
+const std::vector<MarketData>* chunkReadAhead::next()
+{
+    if (holding_)
+    {
+        free_.push(std::move(current_));
+    }
+    holding_ = loaded_.pop(current_);
+    return holding_ ? &current_ : nullptr;
+}
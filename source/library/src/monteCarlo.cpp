@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include "components.h"
+#include "monteCarlo.h"
+
+namespace
+{
+// Compounds a path of log returns. Kept branch-free so the loop is a straight run of
+// adds and max instructions over contiguous memory.
+void summarisePath(const std::vector<double>& path, double& totalReturn, double& maxDrawdown)
+{
+    double cumulative = 0.0;
+    double peak = 0.0;
+    double drawdown = 0.0;
+    for (double logReturn : path)
+    {
+        cumulative += logReturn;
+        peak = std::max(peak, cumulative);
+        drawdown = std::max(drawdown, peak - cumulative);
+    }
+    totalReturn = std::expm1(cumulative);
+    maxDrawdown = -std::expm1(-drawdown);
+}
+
+std::vector<double> toLogReturns(const std::vector<double>& returns)
+{
+    std::vector<double> logs(returns.size());
+    std::transform(returns.begin(), returns.end(), logs.begin(), [](double r) { return std::log1p(r); });
+    return logs;
+}
+}
+
+double monteCarloResult::percentile(const std::vector<double>& values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::vector<double> sorted(values);
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    rank = std::min(rank, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+double monteCarloResult::mean(const std::vector<double>& values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    // Four independent partial sums let the compiler vectorise the reduction
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    std::size_t i = 0;
+    for (; i + 4 <= values.size(); i += 4)
+    {
+        sums[0] += values[i];
+        sums[1] += values[i + 1];
+        sums[2] += values[i + 2];
+        sums[3] += values[i + 3];
+    }
+    for (; i < values.size(); ++i)
+    {
+        sums[0] += values[i];
+    }
+    return (sums[0] + sums[1] + sums[2] + sums[3]) / values.size();
+}
+
+double monteCarloResult::stddev(const std::vector<double>& values)
+{
+    if (values.size() < 2)
+    {
+        return 0.0;
+    }
+    const double mu = mean(values);
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    std::size_t i = 0;
+    for (; i + 4 <= values.size(); i += 4)
+    {
+        for (std::size_t lane = 0; lane < 4; ++lane)
+        {
+            double d = values[i + lane] - mu;
+            sums[lane] += d * d;
+        }
+    }
+    for (; i < values.size(); ++i)
+    {
+        double d = values[i] - mu;
+        sums[0] += d * d;
+    }
+    return std::sqrt((sums[0] + sums[1] + sums[2] + sums[3]) / (values.size() - 1));
+}
+
+void monteCarloResult::print(const std::string& title, std::ostream& out) const
+{
+    out << title << " (" << totalReturn.size() << " resamples)" << std::endl;
+    out << "  Total return | mean: " << mean(totalReturn) << " | std: " << stddev(totalReturn)
+        << " | p5: " << percentile(totalReturn, 5) << " | p50: " << percentile(totalReturn, 50)
+        << " | p95: " << percentile(totalReturn, 95) << std::endl;
+    out << "  Max drawdown | mean: " << mean(maxDrawdown)
+        << " | p50: " << percentile(maxDrawdown, 50) << " | p95: " << percentile(maxDrawdown, 95)
+        << " | p99: " << percentile(maxDrawdown, 99) << std::endl;
+}
+
+template <class Fill>
+monteCarloResult monteCarloEngine::run(std::size_t pathLength, Fill fill) const
+{
+    monteCarloResult result;
+    result.totalReturn.resize(config_.resamples);
+    result.maxDrawdown.resize(config_.resamples);
+
+    const std::size_t numThreads = std::max<std::size_t>(1, config_.numThreads);
+    const std::size_t chunk = (config_.resamples + numThreads - 1) / numThreads;
+
+    ThreadPool pool(numThreads);
+    std::vector<std::future<void>> futures;
+    for (std::size_t begin = 0; begin < config_.resamples; begin += chunk)
+    {
+        const std::size_t end = std::min(begin + chunk, config_.resamples);
+        futures.push_back(pool.enqueue([this, &result, &fill, pathLength, begin, end]() {
+            // One scratch path per worker, reused for every resample in the chunk
+            std::vector<double> path(pathLength);
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                philoxRng rng(config_.seed, i);
+                fill(rng, path);
+                summarisePath(path, result.totalReturn[i], result.maxDrawdown[i]);
+            }
+        }));
+    }
+    for (auto& future : futures)
+    {
+        future.get();
+    }
+    return result;
+}
+
+monteCarloResult monteCarloEngine::tradeShuffle(const std::vector<double>& tradeReturns) const
+{
+    const std::vector<double> logs = toLogReturns(tradeReturns);
+    return run(logs.size(), [&logs](philoxRng& rng, std::vector<double>& path) {
+        std::copy(logs.begin(), logs.end(), path.begin());
+        // Fisher-Yates
+        for (std::size_t i = path.size(); i > 1; --i)
+        {
+            std::swap(path[i - 1], path[rng.bounded(static_cast<std::uint32_t>(i))]);
+        }
+    });
+}
+
+monteCarloResult monteCarloEngine::blockBootstrap(const std::vector<double>& barReturns) const
+{
+    const std::vector<double> logs = toLogReturns(barReturns);
+    const std::size_t blockLength = std::max<std::size_t>(1, config_.blockLength);
+    return run(logs.size(), [&logs, blockLength](philoxRng& rng, std::vector<double>& path) {
+        const std::size_t n = logs.size();
+        std::size_t pos = 0;
+        while (pos < n)
+        {
+            // Blocks wrap around the end of the series (circular bootstrap)
+            std::size_t start = rng.bounded(static_cast<std::uint32_t>(n));
+            std::size_t count = std::min(blockLength, n - pos);
+            std::size_t firstPart = std::min(count, n - start);
+            std::copy_n(logs.begin() + start, firstPart, path.begin() + pos);
+            std::copy_n(logs.begin(), count - firstPart, path.begin() + pos + firstPart);
+            pos += count;
+        }
+    });
+}
+
+monteCarloResult monteCarloEngine::randomEntry(const std::vector<double>& closes, std::size_t numTrades, std::size_t holdBars) const
+{
+    if (closes.size() <= holdBars)
+    {
+        std::cerr << "Not enough bars for a random entry baseline with hold " << holdBars << std::endl;
+        return run(0, [](philoxRng&, std::vector<double>&) {});
+    }
+
+    // Trade log return between any two bars is a difference of log prices
+    std::vector<double> logPrices(closes.size());
+    std::transform(closes.begin(), closes.end(), logPrices.begin(), [](double c) { return std::log(c); });
+    const std::uint32_t entries = static_cast<std::uint32_t>(closes.size() - holdBars);
+
+    return run(numTrades, [&logPrices, entries, holdBars](philoxRng& rng, std::vector<double>& path) {
+        for (double& tradeReturn : path)
+        {
+            std::size_t entry = rng.bounded(entries);
+            tradeReturn = logPrices[entry + holdBars] - logPrices[entry];
+        }
+    });
+}
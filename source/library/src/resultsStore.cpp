@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "resultsStore.h"
+
+namespace
+{
+// Fixed-width, zero padded copy of a text value
+template <std::size_t Width>
+struct fixedText
+{
+    explicit fixedText(std::string_view text)
+    {
+        std::memcpy(data, text.data(), std::min(text.size(), Width));
+    }
+    char data[Width] = {};
+};
+}
+
+resultsTable::resultsTable(const std::filesystem::path& path, const std::vector<columnSpec>& schema, std::size_t rowsPerChunk)
+    : name_(path.stem().string()), file_(path, schema), rowsPerChunk_(rowsPerChunk)
+{
+    for (buffer* buf : {&active_, &spare_})
+    {
+        for (const auto& col : schema)
+        {
+            buf->columns.emplace_back(rowsPerChunk_ * col.width);
+        }
+    }
+}
+
+resultsWriter::resultsWriter(const std::filesystem::path& directory, std::size_t rowsPerChunk)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    rowsPerChunk = std::max<std::size_t>(1, rowsPerChunk);
+
+    const columnSpec timestamp = columnSpec::text("timestamp", TIMESTAMP_WIDTH);
+    fills_ = std::make_unique<resultsTable>(directory / "fills.qcol",
+        std::vector<columnSpec>{timestamp, columnSpec::i64("side"), columnSpec::f64("fraction"), columnSpec::f64("price"), columnSpec::f64("cash")}, rowsPerChunk);
+    positions_ = std::make_unique<resultsTable>(directory / "positions.qcol",
+        std::vector<columnSpec>{timestamp, columnSpec::f64("asset"), columnSpec::f64("cash"), columnSpec::i64("inPosition")}, rowsPerChunk);
+    equity_ = std::make_unique<resultsTable>(directory / "equity.qcol",
+        std::vector<columnSpec>{timestamp, columnSpec::f64("equity")}, rowsPerChunk);
+    metrics_ = std::make_unique<resultsTable>(directory / "metrics.qcol",
+        std::vector<columnSpec>{columnSpec::i64("configId"), columnSpec::text("metric", METRIC_WIDTH), columnSpec::f64("value")}, rowsPerChunk);
+
+    for (resultsTable* table : {fills_.get(), positions_.get(), equity_.get(), metrics_.get()})
+    {
+        good_ = good_ && table->file_.good();
+    }
+    writerThread_ = std::thread(&resultsWriter::writerLoop, this);
+}
+
+resultsWriter::~resultsWriter()
+{
+    close();
+}
+
+void resultsWriter::recordFill(std::string_view timestamp, int side, double fraction, double price, double cash)
+{
+    fixedText<TIMESTAMP_WIDTH> ts(timestamp);
+    std::int64_t sideCode = side;
+    append(*fills_, {ts.data, &sideCode, &fraction, &price, &cash});
+}
+
+void resultsWriter::recordPosition(std::string_view timestamp, double asset, double cash, bool inPosition)
+{
+    fixedText<TIMESTAMP_WIDTH> ts(timestamp);
+    std::int64_t flag = inPosition ? 1 : 0;
+    append(*positions_, {ts.data, &asset, &cash, &flag});
+}
+
+void resultsWriter::recordEquity(std::string_view timestamp, double equity)
+{
+    fixedText<TIMESTAMP_WIDTH> ts(timestamp);
+    append(*equity_, {ts.data, &equity});
+}
+
+void resultsWriter::recordMetric(std::int64_t configId, std::string_view metric, double value)
+{
+    fixedText<METRIC_WIDTH> name(metric);
+    append(*metrics_, {&configId, name.data, &value});
+}
+
+void resultsWriter::append(resultsTable& table, std::initializer_list<const void*> values)
+{
+    std::unique_lock<std::mutex> lock(table.mutex_);
+    resultsTable::buffer& buf = table.active_;
+    // Another producer filled the buffer and is waiting for the spare
+    while (buf.rows == table.rowsPerChunk_)
+    {
+        handOver(table, lock);
+    }
+    const auto& schema = table.file_.schema();
+    std::size_t i = 0;
+    for (const void* value : values)
+    {
+        const std::size_t width = schema[i].width;
+        std::memcpy(buf.columns[i].data() + buf.rows * width, value, width);
+        ++i;
+    }
+    if (++buf.rows == table.rowsPerChunk_)
+    {
+        handOver(table, lock);
+    }
+}
+
+void resultsWriter::handOver(resultsTable& table, std::unique_lock<std::mutex>& lock)
+{
+    // Back pressure only if the writer has not finished the previous chunk of this table
+    table.spareFree_.wait(lock, [&table] { return !table.spareBusy_; });
+    if (table.active_.rows == 0)
+    {
+        // Handed over by another producer while this one was waiting
+        return;
+    }
+    std::swap(table.active_, table.spare_);
+    table.active_.rows = 0;
+    table.spareBusy_ = true;
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex_);
+        queue_.push_back(&table);
+    }
+    queueReady_.notify_one();
+}
+
+void resultsWriter::writerLoop()
+{
+    while (true)
+    {
+        resultsTable* table;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+            if (queue_.empty())
+            {
+                return;
+            }
+            table = queue_.front();
+            queue_.pop_front();
+        }
+
+        // While spareBusy_ is set the spare buffer belongs to this thread
+        resultsTable::buffer& buf = table->spare_;
+        std::vector<const void*> columns;
+        for (const auto& column : buf.columns)
+        {
+            columns.push_back(column.data());
+        }
+        if (!table->file_.appendChunk(columns, buf.rows))
+        {
+            std::cerr << "Error writing results table: " << table->name() << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(table->mutex_);
+            table->spareBusy_ = false;
+        }
+        table->spareFree_.notify_all();
+    }
+}
+
+void resultsWriter::flush()
+{
+    for (resultsTable* table : {fills_.get(), positions_.get(), equity_.get(), metrics_.get()})
+    {
+        std::unique_lock<std::mutex> lock(table->mutex_);
+        if (table->active_.rows > 0)
+        {
+            handOver(*table, lock);
+        }
+    }
+    for (resultsTable* table : {fills_.get(), positions_.get(), equity_.get(), metrics_.get()})
+    {
+        std::unique_lock<std::mutex> lock(table->mutex_);
+        table->spareFree_.wait(lock, [table] { return !table->spareBusy_; });
+        table->file_.flush();
+    }
+}
+
+void resultsWriter::close()
+{
+    if (!writerThread_.joinable())
+    {
+        return;
+    }
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueReady_.notify_all();
+    writerThread_.join();
+}
+
+bool resultsReader::exportCsv(const std::string& table, const std::filesystem::path& csvPath) const
+{
+    columnarReader in = this->table(table);
+    if (!in.good())
+    {
+        std::cerr << "Error opening results table: " << table << std::endl;
+        return false;
+    }
+    std::ofstream out(csvPath);
+    if (!out.is_open())
+    {
+        std::cerr << "Error opening file: " << csvPath << std::endl;
+        return false;
+    }
+
+    const auto& schema = in.schema();
+    std::vector<const std::vector<char>*> columns;
+    for (std::size_t c = 0; c < schema.size(); ++c)
+    {
+        out << (c ? "," : "") << schema[c].name;
+        columns.push_back(in.raw(schema[c].name));
+    }
+    out << '\n' << std::setprecision(17);
+
+    for (std::uint64_t row = 0; row < in.rowCount(); ++row)
+    {
+        for (std::size_t c = 0; c < schema.size(); ++c)
+        {
+            const char* value = columns[c]->data() + row * schema[c].width;
+            out << (c ? "," : "");
+            switch (schema[c].type)
+            {
+            case columnType::f64:
+            {
+                double v;
+                std::memcpy(&v, value, sizeof(v));
+                out << v;
+                break;
+            }
+            case columnType::i64:
+            {
+                std::int64_t v;
+                std::memcpy(&v, value, sizeof(v));
+                out << v;
+                break;
+            }
+            case columnType::text:
+                out.write(value, strnlen(value, schema[c].width));
+                break;
+            }
+        }
+        out << '\n';
+    }
+    return true;
+}
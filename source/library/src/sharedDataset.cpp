@@ -0,0 +1,251 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "columnar.h"
+#include "marketDataCache.h"
+#include "sharedDataset.h"
+
+namespace
+{
+constexpr char SHM_MAGIC[8] = {'Q', 'E', 'N', 'G', 'S', 'H', 'M', '1'};
+constexpr std::size_t COLUMN_ALIGNMENT = 64;
+
+std::string shmName(const std::string& name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::uint64_t alignUp(std::uint64_t offset)
+{
+    return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+}
+
+// Whether rows values of width bytes starting at offset lie inside a segment of size bytes
+bool fits(std::uint64_t offset, std::uint64_t rows, std::uint64_t width, std::uint64_t size)
+{
+    return offset <= size && (width == 0 || rows <= (size - offset) / width);
+}
+}
+
+void sharedDatasetServer::add(const std::string& symbol, const std::vector<MarketData>& bars)
+{
+    staged data;
+    data.symbol = symbol;
+    data.rows = bars.size();
+    data.timestamps.assign(bars.size() * MARKET_DATA_TIMESTAMP_WIDTH, '\0');
+    for (std::size_t i = 0; i < bars.size(); ++i)
+    {
+        const std::string& ts = bars[i].timestamp;
+        std::copy_n(ts.data(), std::min<std::size_t>(ts.size(), MARKET_DATA_TIMESTAMP_WIDTH), data.timestamps.data() + i * MARKET_DATA_TIMESTAMP_WIDTH);
+        data.open.push_back(bars[i].open);
+        data.high.push_back(bars[i].high);
+        data.low.push_back(bars[i].low);
+        data.close.push_back(bars[i].close);
+        data.volume.push_back(bars[i].volume);
+    }
+    datasets_.push_back(std::move(data));
+}
+
+bool sharedDatasetServer::addCache(const std::string& symbol, const std::filesystem::path& cachePath)
+{
+    columnarReader in(cachePath);
+    if (!isMarketDataCache(in))
+    {
+        std::cerr << "Not a market data cache: " << cachePath << std::endl;
+        return false;
+    }
+    staged data;
+    data.symbol = symbol;
+    data.rows = in.rowCount();
+    data.timestamps = *in.raw("timestamp");
+    data.open = in.f64("open");
+    data.high = in.f64("high");
+    data.low = in.f64("low");
+    data.close = in.f64("close");
+    data.volume = in.f64("volume");
+    datasets_.push_back(std::move(data));
+    return true;
+}
+
+bool sharedDatasetServer::publish(const std::string& name) const
+{
+    // Lay out catalog and columns
+    std::vector<sharedDatasetEntry> catalog(datasets_.size());
+    std::uint64_t offset = alignUp(sizeof(sharedDatasetHeader) + catalog.size() * sizeof(sharedDatasetEntry));
+    for (std::size_t d = 0; d < datasets_.size(); ++d)
+    {
+        const staged& data = datasets_[d];
+        sharedDatasetEntry& entry = catalog[d];
+        std::memset(&entry, 0, sizeof(entry));
+        std::strncpy(entry.symbol, data.symbol.c_str(), sizeof(entry.symbol) - 1);
+        entry.rowCount = data.rows;
+        entry.timestampWidth = MARKET_DATA_TIMESTAMP_WIDTH;
+
+        entry.timestampOffset = offset;
+        offset = alignUp(offset + data.timestamps.size());
+        for (std::uint64_t* column : {&entry.openOffset, &entry.highOffset, &entry.lowOffset, &entry.closeOffset, &entry.volumeOffset})
+        {
+            *column = offset;
+            offset = alignUp(offset + data.rows * sizeof(double));
+        }
+    }
+    const std::uint64_t segmentSize = offset;
+
+    const std::string shm = shmName(name);
+    ::shm_unlink(shm.c_str());
+    int fd = ::shm_open(shm.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error creating shared memory segment " << shm << " (" << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(segmentSize)) < 0)
+    {
+        std::cerr << "Error sizing shared memory segment " << shm << " (" << std::strerror(errno) << ")" << std::endl;
+        ::close(fd);
+        ::shm_unlink(shm.c_str());
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Error mapping shared memory segment " << shm << " (" << std::strerror(errno) << ")" << std::endl;
+        ::shm_unlink(shm.c_str());
+        return false;
+    }
+
+    char* base = static_cast<char*>(mapped);
+    auto* header = new (base) sharedDatasetHeader{};
+    std::memcpy(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+    header->version = 1;
+    header->datasetCount = static_cast<std::uint32_t>(catalog.size());
+    header->segmentSize = segmentSize;
+    std::memcpy(base + sizeof(sharedDatasetHeader), catalog.data(), catalog.size() * sizeof(sharedDatasetEntry));
+
+    for (std::size_t d = 0; d < datasets_.size(); ++d)
+    {
+        const staged& data = datasets_[d];
+        const sharedDatasetEntry& entry = catalog[d];
+        std::memcpy(base + entry.timestampOffset, data.timestamps.data(), data.timestamps.size());
+        std::memcpy(base + entry.openOffset, data.open.data(), data.rows * sizeof(double));
+        std::memcpy(base + entry.highOffset, data.high.data(), data.rows * sizeof(double));
+        std::memcpy(base + entry.lowOffset, data.low.data(), data.rows * sizeof(double));
+        std::memcpy(base + entry.closeOffset, data.close.data(), data.rows * sizeof(double));
+        std::memcpy(base + entry.volumeOffset, data.volume.data(), data.rows * sizeof(double));
+    }
+
+    // Clients refuse a segment until this is set
+    header->ready.store(1, std::memory_order_release);
+    ::munmap(mapped, segmentSize);
+    return true;
+}
+
+sharedDataset::sharedDataset(const std::string& name)
+{
+    const std::string shm = shmName(name);
+    int fd = ::shm_open(shm.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Error opening shared memory segment " << shm << " (" << std::strerror(errno) << ")" << std::endl;
+        return;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < sizeof(sharedDatasetHeader))
+    {
+        std::cerr << "Shared memory segment " << shm << " is empty" << std::endl;
+        ::close(fd);
+        return;
+    }
+    void* mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        std::cerr << "Error mapping shared memory segment " << shm << " (" << std::strerror(errno) << ")" << std::endl;
+        return;
+    }
+
+    const auto* header = static_cast<const sharedDatasetHeader*>(mapped);
+    if (std::memcmp(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC)) != 0 || header->ready.load(std::memory_order_acquire) != 1 ||
+        header->segmentSize > static_cast<std::uint64_t>(info.st_size) ||
+        !fits(sizeof(sharedDatasetHeader), header->datasetCount, sizeof(sharedDatasetEntry), info.st_size))
+    {
+        std::cerr << "Shared memory segment " << shm << " is not a published dataset" << std::endl;
+        ::munmap(mapped, info.st_size);
+        return;
+    }
+    base_ = static_cast<const char*>(mapped);
+    size_ = info.st_size;
+}
+
+sharedDataset::~sharedDataset()
+{
+    if (base_)
+    {
+        ::munmap(const_cast<char*>(base_), size_);
+    }
+}
+
+std::vector<std::string> sharedDataset::symbols() const
+{
+    std::vector<std::string> names;
+    if (!base_)
+    {
+        return names;
+    }
+    const auto* header = reinterpret_cast<const sharedDatasetHeader*>(base_);
+    const auto* catalog = reinterpret_cast<const sharedDatasetEntry*>(base_ + sizeof(sharedDatasetHeader));
+    for (std::uint32_t d = 0; d < header->datasetCount; ++d)
+    {
+        names.emplace_back(catalog[d].symbol, strnlen(catalog[d].symbol, sizeof(catalog[d].symbol)));
+    }
+    return names;
+}
+
+marketDataView sharedDataset::find(const std::string& symbol) const
+{
+    marketDataView view;
+    if (!base_)
+    {
+        return view;
+    }
+    const auto* header = reinterpret_cast<const sharedDatasetHeader*>(base_);
+    const auto* catalog = reinterpret_cast<const sharedDatasetEntry*>(base_ + sizeof(sharedDatasetHeader));
+    for (std::uint32_t d = 0; d < header->datasetCount; ++d)
+    {
+        const sharedDatasetEntry& entry = catalog[d];
+        if (symbol == std::string(entry.symbol, strnlen(entry.symbol, sizeof(entry.symbol))))
+        {
+            // The catalog is trusted no further than the mapping: a column outside it gives an empty view
+            bool inside = fits(entry.timestampOffset, entry.rowCount, entry.timestampWidth, size_);
+            for (std::uint64_t offset : {entry.openOffset, entry.highOffset, entry.lowOffset, entry.closeOffset, entry.volumeOffset})
+            {
+                inside = inside && offset % alignof(double) == 0 && fits(offset, entry.rowCount, sizeof(double), size_);
+            }
+            if (!inside)
+            {
+                std::cerr << "Shared dataset entry " << symbol << " lies outside the segment" << std::endl;
+                break;
+            }
+            view.size = entry.rowCount;
+            view.timestampWidth = entry.timestampWidth;
+            view.timestamps = base_ + entry.timestampOffset;
+            view.open = reinterpret_cast<const double*>(base_ + entry.openOffset);
+            view.high = reinterpret_cast<const double*>(base_ + entry.highOffset);
+            view.low = reinterpret_cast<const double*>(base_ + entry.lowOffset);
+            view.close = reinterpret_cast<const double*>(base_ + entry.closeOffset);
+            view.volume = reinterpret_cast<const double*>(base_ + entry.volumeOffset);
+            break;
+        }
+    }
+    return view;
+}
+
+bool sharedDataset::remove(const std::string& name)
+{
+    return ::shm_unlink(shmName(name).c_str()) == 0;
+}
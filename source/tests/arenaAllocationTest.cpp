@@ -0,0 +1,99 @@
+// Acceptance check for the replay arena: once the arena has grown during a first replay, a
+// second full simulateMarketData with the ThresholdStrategy and broker subscribed must not
+// call the global operator new. Also checks that what a subscriber copies or moves out of
+// the replay lives on the heap, not in the arena that is rewound under it.
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+#include "components.h"
+#include "thresholdStrategy.h"
+
+static std::atomic<long> allocations{0};
+static std::atomic<bool> counting{false};
+
+void* operator new(std::size_t size)
+{
+    if (counting.load(std::memory_order_relaxed))
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main()
+{
+    std::vector<MarketData> bars;
+    for (int i = 0; i < 200000; ++i)
+    {
+        bars.emplace_back("2023-11-28 19:32:20", 1, 2, 0.5, 1.5 + i % 3, 10);
+    }
+
+    rngService::setSeed(42);
+    eventBus buss;
+    ThresholdStrategy strategy(buss, 10, 50);
+    broker brkr(buss);
+    dataHandler handler(buss, bars);
+
+    std::cout.setstate(std::ios::failbit);
+    handler.simulateMarketData();
+
+    counting = true;
+    handler.resetIteration();
+    handler.simulateMarketData();
+    counting = false;
+    std::cout.clear();
+
+    int failures = 0;
+    std::cout << "operator new calls in a steady-state replay of " << bars.size() << " bars: " << allocations << std::endl;
+    if (allocations != 0)
+    {
+        ++failures;
+    }
+
+    // Subscribers keeping what they see beyond the arena's next reset: copies of event
+    // timestamps, and strategy results moved into a history
+    std::vector<arenaString> timestamps;
+    std::vector<signalMap> history;
+    buss.subscribe("Signal", [&timestamps](event& evnt) { timestamps.push_back(evnt.timestamp); });
+    buss.subscribe("MarketData", [&history, &strategy](event& evnt) {
+        if (auto marketDataEventPtr = dynamic_cast<marketDataEvent*>(&evnt))
+        {
+            signalMap signal = strategy.generateSignal(marketDataEventPtr->data_);
+            history.push_back(std::move(signal));
+        }
+    });
+    std::cout.setstate(std::ios::failbit);
+    handler.resetIteration();
+    handler.simulateMarketData();
+    std::cout.clear();
+
+    for (const auto& timestamp : timestamps)
+    {
+        if (timestamp.get_allocator().arena() != nullptr || timestamp != "2023-11-28 19:32:20")
+        {
+            std::cout << "Copied event timestamp lives in the replay arena" << std::endl;
+            ++failures;
+            break;
+        }
+    }
+    for (const auto& signal : history)
+    {
+        auto type = signal.find("type");
+        if (signal.get_allocator().arena() != nullptr || type == signal.end() || type->second < 0 || type->second > 2)
+        {
+            std::cout << "Moved signal payload lives in the replay arena" << std::endl;
+            ++failures;
+            break;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
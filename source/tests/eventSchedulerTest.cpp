@@ -0,0 +1,137 @@
+// Ordering checks for eventScheduler: simulated time never goes backwards, events run at
+// the time they were scheduled for (clamped to now), and equal times keep scheduling order,
+// including when run(until) stops early and more events are scheduled afterwards. Also
+// checks that a scheduled eventBus runs published events after the handler, not within it.
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "components.h"
+#include "eventScheduler.h"
+#include "rng.h"
+
+struct dispatched
+{
+    std::uint64_t id;
+    std::uint64_t time;
+};
+
+static simEvent timer(std::uint64_t id)
+{
+    simEvent evnt;
+    evnt.id = id;
+    return evnt;
+}
+
+static int expect(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    int failures = 0;
+    std::vector<dispatched> log;
+    auto record = [&log](eventScheduler& sched) {
+        sched.on(simEventType::timer, [&log, &sched](const simEvent& evnt) { log.push_back({evnt.id, sched.now()}); });
+    };
+
+    // Stopping before a pending event, then scheduling an earlier one
+    {
+        eventScheduler sched;
+        record(sched);
+        sched.at(100, timer(1));
+        sched.run(50);
+        sched.at(10, timer(2));
+        sched.at(60, timer(3));
+        sched.run();
+        failures += expect(log.size() == 3, "all events dispatched after run(until)");
+        failures += expect(log.size() == 3 && log[0].id == 2 && log[0].time == 50, "past event runs at the clock run(until) left");
+        failures += expect(log.size() == 3 && log[1].id == 3 && log[1].time == 60, "event between until and the pending one runs first");
+        failures += expect(log.size() == 3 && log[2].id == 1 && log[2].time == 100, "pending event keeps its time");
+    }
+
+    // Equal times come out in scheduling order
+    log.clear();
+    {
+        eventScheduler sched;
+        record(sched);
+        for (std::uint64_t id = 0; id < 5; ++id)
+        {
+            sched.at(7, timer(id));
+        }
+        sched.run();
+        bool fifo = log.size() == 5;
+        for (std::size_t i = 0; fifo && i < log.size(); ++i)
+        {
+            fifo = log[i].id == i;
+        }
+        failures += expect(fifo, "equal times dispatched in scheduling order");
+    }
+
+    // Random schedules interleaved with partial runs
+    log.clear();
+    {
+        eventScheduler sched;
+        record(sched);
+        philoxRng rng(3, 0);
+        std::vector<std::uint64_t> due;
+        std::uint64_t horizon = 0;
+        for (int round = 0; round < 2000; ++round)
+        {
+            for (int i = 0; i < 50; ++i)
+            {
+                const std::uint64_t time = sched.now() + rng.bounded(1 << 20);
+                due.push_back(time);
+                sched.at(time, timer(due.size() - 1));
+            }
+            horizon += rng.bounded(1 << 19);
+            sched.run(horizon);
+        }
+        sched.run();
+
+        bool ordered = log.size() == due.size();
+        for (std::size_t i = 0; ordered && i < log.size(); ++i)
+        {
+            ordered = log[i].time == due[log[i].id] && (i == 0 || log[i - 1].time <= log[i].time);
+        }
+        failures += expect(ordered, "random schedules dispatched on time and in order");
+    }
+
+    // Strategy-like handler publishing a signal for every bar
+    for (dispatchMode mode : {dispatchMode::immediate, dispatchMode::scheduled})
+    {
+        eventBus buss(mode);
+        std::vector<std::string> trace;
+        buss.subscribe("MarketData", [&buss, &trace](event& evnt) {
+            trace.push_back("bar");
+            signalEvent sigEvent{std::string_view(evnt.timestamp.data(), evnt.timestamp.size()), {{"type", 1}}};
+            buss.publish(sigEvent);
+            trace.push_back("bar done");
+        });
+        buss.subscribe("Signal", [&trace](event& evnt) {
+            auto signalEventPtr = dynamic_cast<signalEvent*>(&evnt);
+            trace.push_back(signalEventPtr && signalEventPtr->data_.at("type") == 1 ? "signal" : "bad signal");
+        });
+
+        MarketData bar("2023-11-28 19:32:20", 1, 2, 0.5, 1.5, 10);
+        for (int i = 0; i < 2; ++i)
+        {
+            marketDataEvent mDataEvent{bar.timestamp, bar};
+            buss.publish(mDataEvent);
+        }
+
+        const std::vector<std::string> expected = mode == dispatchMode::immediate
+            ? std::vector<std::string>{"bar", "signal", "bar done", "bar", "signal", "bar done"}
+            : std::vector<std::string>{"bar", "bar done", "signal", "bar", "bar done", "signal"};
+        failures += expect(trace == expected, mode == dispatchMode::immediate ? "immediate bus nests the signal in the bar handler"
+                                                                             : "scheduled bus runs the signal after the bar handler");
+    }
+
+    return failures == 0 ? 0 : 1;
+}